@@ -0,0 +1,219 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_BIT_PARALLEL_SIMULATION_H
+#define RIPPLES_BIT_PARALLEL_SIMULATION_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ripples/diffusion_simulation.h"
+
+namespace ripples {
+
+//! \brief Independent Cascade simulation of many worlds at once.
+//!
+//! Every vertex holds a bitmask of the worlds where it is active, Worlds / 64
+//! words wide.  A BFS level pushes, along every edge (v, u), the worlds where
+//! v has just been activated, filtered by a random mask where each bit is set
+//! with the probability of the edge.  A vertex is visited once per level for
+//! all the worlds, so a batch of 64 or 256 replicas costs about as much as a
+//! few scalar ones.  The scratch arrays are reused across batches.
+//!
+//! \tparam GraphTy The type of the input graph.
+//! \tparam Worlds The number of worlds simulated together, a multiple of 64.
+template <typename GraphTy, size_t Worlds = 64>
+class BitParallelICSimulator {
+  static_assert(Worlds % 64 == 0, "Worlds must be a multiple of 64");
+  static constexpr size_t Words = Worlds / 64;
+  //! Bits of precision of the edge probabilities.
+  static constexpr size_t PrecisionBits = 16;
+
+  using vertex_type = typename GraphTy::vertex_type;
+
+ public:
+  //! The number of worlds simulated by every call to simulate().
+  static constexpr size_t num_worlds = Worlds;
+
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  explicit BitParallelICSimulator(const GraphTy &G)
+      : G_(G),
+        active_(G.num_nodes() * Words, 0),
+        fresh_(G.num_nodes() * Words, 0),
+        next_(G.num_nodes() * Words, 0) {}
+
+  //! \brief Simulate the diffusion from a seed set in Worlds worlds.
+  //!
+  //! \param begin The start of the sequence of seeds.
+  //! \param end The end of the sequence of seeds.
+  //! \param generator The random number generator.
+  //! \return for every world, the pair (A, S) where A is the number of
+  //! activated nodes and S the number of steps, as simulate() does.
+  template <typename Iterator, typename PRNG>
+  std::vector<std::pair<size_t, size_t>> simulate(Iterator begin, Iterator end,
+                                                  PRNG &generator) {
+    std::vector<std::pair<size_t, size_t>> result(Worlds, {0, 0});
+    touched_.clear();
+    frontier_.clear();
+
+    for (auto itr = begin; itr != end; ++itr) {
+      vertex_type v = *itr;
+      if (word(active_, v, 0) == ~uint64_t(0)) continue;
+      touched_.push_back(v);
+      frontier_.push_back(v);
+      for (size_t w = 0; w < Words; ++w)
+        word(active_, v, w) = word(fresh_, v, w) = ~uint64_t(0);
+    }
+
+    size_t level = 0;
+    while (!frontier_.empty()) {
+      next_frontier_.clear();
+      uint64_t progress[Words] = {};
+
+      for (vertex_type v : frontier_) {
+        for (auto &e : G_.neighbors(v)) {
+          vertex_type u = e.vertex;
+          bool reached = false;
+          for (size_t w = 0; w < Words; ++w) {
+            uint64_t candidates = word(fresh_, v, w) & ~word(active_, u, w);
+            if (candidates == 0) continue;
+            uint64_t mask = candidates & bernoulli_mask(e.weight, generator);
+            if (mask == 0) continue;
+            if (!reached) {
+              if (!any(active_, u)) touched_.push_back(u);
+              if (!any(next_, u)) next_frontier_.push_back(u);
+              reached = true;
+            }
+            word(active_, u, w) |= mask;
+            word(next_, u, w) |= mask;
+            progress[w] |= mask;
+          }
+        }
+        for (size_t w = 0; w < Words; ++w) word(fresh_, v, w) = 0;
+      }
+
+      // The worlds that made progress run at least one more step.
+      ++level;
+      for (size_t w = 0; w < Words; ++w)
+        for (uint64_t bits = progress[w]; bits != 0; bits &= bits - 1)
+          result[w * 64 + __builtin_ctzll(bits)].second = level;
+
+      for (vertex_type u : next_frontier_)
+        for (size_t w = 0; w < Words; ++w) {
+          word(fresh_, u, w) = word(next_, u, w);
+          word(next_, u, w) = 0;
+        }
+      frontier_.swap(next_frontier_);
+    }
+
+    // As in the scalar simulation, the last level, which activates nothing,
+    // is counted as a step.
+    for (auto &world : result) world.second += 1;
+
+    for (vertex_type v : touched_)
+      for (size_t w = 0; w < Words; ++w) {
+        for (uint64_t bits = word(active_, v, w); bits != 0; bits &= bits - 1)
+          ++result[w * 64 + __builtin_ctzll(bits)].first;
+        word(active_, v, w) = 0;
+      }
+    return result;
+  }
+
+ private:
+  uint64_t &word(std::vector<uint64_t> &bits, vertex_type v, size_t w) {
+    return bits[v * Words + w];
+  }
+
+  bool any(std::vector<uint64_t> &bits, vertex_type v) {
+    for (size_t w = 0; w < Words; ++w)
+      if (word(bits, v, w) != 0) return true;
+    return false;
+  }
+
+  //! A random word, with the low-quality low bits of the LCG mixed in.
+  template <typename PRNG>
+  static uint64_t random_word(PRNG &generator) {
+    uint64_t x = generator();
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+  //! \brief A word whose bits are set independently with probability p.
+  //!
+  //! With p written in binary as 0.b1 b2 ... bP, the mask is built from the
+  //! least significant digit: m = b ? (m | r) : (m & r) for fresh random words
+  //! r.  Each bit of the result is then set with probability p truncated to P
+  //! digits.
+  template <typename WeightTy, typename PRNG>
+  static uint64_t bernoulli_mask(WeightTy p, PRNG &generator) {
+    if (p <= 0) return 0;
+    if (p >= 1) return ~uint64_t(0);
+    uint32_t fixed = p * (1u << PrecisionBits);
+    if (fixed == 0) return 0;
+    unsigned skip = __builtin_ctz(fixed);
+    uint64_t mask = 0;
+    for (size_t b = skip; b < PrecisionBits; ++b) {
+      uint64_t r = random_word(generator);
+      mask = (fixed >> b) & 1 ? (mask | r) : (mask & r);
+    }
+    return mask;
+  }
+
+  const GraphTy &G_;
+  std::vector<uint64_t> active_;
+  std::vector<uint64_t> fresh_;
+  std::vector<uint64_t> next_;
+  std::vector<vertex_type> touched_;
+  std::vector<vertex_type> frontier_;
+  std::vector<vertex_type> next_frontier_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_BIT_PARALLEL_SIMULATION_H
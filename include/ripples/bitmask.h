@@ -44,63 +44,252 @@
 #define RIPPLES_BITMASK_H
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <new>
+#include <type_traits>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Bitmask assumes a little-endian word layout"
+#endif
 
 namespace ripples {
-template <typename BaseTy>
+
+//! \brief A fixed-size set of bits stored in 64-bit words.
+//!
+//! The storage is aligned to a cache line and padded to a whole number of
+//! cache lines, so that bulk operations run over full vectors without a
+//! scalar tail.  Bits past size() stay zero unless written through data().
+//!
+//! The template parameter only selects the word type exposed by data().
+//! Bit i lives at bit i % 64 of word i / 64, which on a little-endian machine
+//! is the same layout as bit i % 32 of the i / 32 int.  Bitmask<int> can
+//! therefore be handed to the CUDA kernels working on int words.
+//!
+//! \tparam BaseTy The word type seen through data().
+template <typename BaseTy = uint64_t>
 class Bitmask {
  public:
+  using word_type = uint64_t;
+
+  //! The number of bits in a storage word.
+  static constexpr size_t word_bits = 8 * sizeof(word_type);
+  //! The alignment, and padding granularity, of the storage in bytes.
+  static constexpr size_t alignment = 64;
+
+  static_assert(std::is_integral<BaseTy>::value,
+                "Bitmask words must be integral");
+  static_assert(sizeof(word_type) % sizeof(BaseTy) == 0,
+                "BaseTy must evenly divide a 64-bit word");
+
   Bitmask() : size_(0), data_size_(0), data_(nullptr) {}
   Bitmask(const Bitmask &O)
-      : size_(O.size_),
-        data_size_(O.data_size_),
-        data_(new BaseTy[O.data_size_]) {
-    std::memcpy(data_.get(), O.data_.get(), data_size_ * sizeof(BaseTy));
+      : size_(O.size_), data_size_(O.data_size_), data_(allocate(data_size_)) {
+    std::memcpy(data_.get(), O.data_.get(), bytes());
   }
 
-  Bitmask(Bitmask &&) = default;
+  Bitmask(Bitmask &&O) noexcept
+      : size_(O.size_), data_size_(O.data_size_), data_(std::move(O.data_)) {
+    O.size_ = O.data_size_ = 0;
+  }
 
   explicit Bitmask(size_t num_bits)
       : size_(num_bits),
-        data_size_((size_ / (8 * sizeof(BaseTy)) + 1)),
-        data_(new BaseTy[(size_ / (8 * sizeof(BaseTy)) + 1)]) {
-    std::memset(data_.get(), 0, data_size_ * sizeof(BaseTy));
+        data_size_(num_words(num_bits)),
+        data_(allocate(data_size_)) {
+    clear();
   }
 
   Bitmask &operator=(const Bitmask &O) {
+    if (this == &O) return *this;
+    if (data_size_ != O.data_size_) {
+      data_ = allocate(O.data_size_);
+      data_size_ = O.data_size_;
+    }
+    size_ = O.size_;
+    std::memcpy(data_.get(), O.data_.get(), bytes());
+    return *this;
+  }
+  Bitmask &operator=(Bitmask &&O) noexcept {
     size_ = O.size_;
     data_size_ = O.data_size_;
-    data_ = std::unique_ptr<BaseTy[]>(new BaseTy[data_size_]);
-    std::memcpy(data_.get(), O.data_.get(), data_size_ * sizeof(BaseTy));
+    data_ = std::move(O.data_);
+    O.size_ = O.data_size_ = 0;
     return *this;
   }
-  Bitmask &operator=(Bitmask &&) = default;
 
-  void set(size_t i) {
-    BaseTy m = 1 << (i % (8 * sizeof(BaseTy)));
-    data_[i / (8 * sizeof(BaseTy))] |= m;
+  void set(size_t i) { data_[i / word_bits] |= mask(i); }
+  void unset(size_t i) { data_[i / word_bits] &= ~mask(i); }
+  bool get(size_t i) const { return data_[i / word_bits] & mask(i); }
+
+  //! \brief Set bit i.
+  //! \return true if the bit was clear before the call.
+  bool test_and_set(size_t i) {
+    word_type &w = data_[i / word_bits];
+    word_type m = mask(i);
+    bool was_clear = !(w & m);
+    w |= m;
+    return was_clear;
   }
-  bool get(size_t i) const {
-    BaseTy m = 1 << (i % (8 * sizeof(BaseTy)));
-    return data_[i / (8 * sizeof(BaseTy))] & m;
+
+  void clear() {
+    if (data_size_) std::memset(data_.get(), 0, bytes());
   }
 
   size_t popcount() const {
+    const word_type *d = words();
     size_t count = 0;
+#pragma omp simd reduction(+ : count)
     for (size_t i = 0; i < data_size_; ++i) {
-      count += __builtin_popcount(data_[i]);
+      count += __builtin_popcountll(d[i]);
     }
     return count;
   }
 
-  BaseTy *data() const { return data_.get(); }
-  size_t bytes() const { return data_size_ * sizeof(BaseTy); }
+  //! \brief Count the bits set both here and in O.
+  size_t popcount_and(const Bitmask &O) const {
+    const word_type *a = words();
+    const word_type *b = O.words();
+    size_t count = 0;
+#pragma omp simd reduction(+ : count)
+    for (size_t i = 0; i < data_size_; ++i) {
+      count += __builtin_popcountll(a[i] & b[i]);
+    }
+    return count;
+  }
+
+  //! \brief Count the bits set here but not in O.
+  size_t popcount_and_not(const Bitmask &O) const {
+    const word_type *a = words();
+    const word_type *b = O.words();
+    size_t count = 0;
+#pragma omp simd reduction(+ : count)
+    for (size_t i = 0; i < data_size_; ++i) {
+      count += __builtin_popcountll(a[i] & ~b[i]);
+    }
+    return count;
+  }
+
+  bool any() const {
+    const word_type *d = words();
+    word_type acc = 0;
+#pragma omp simd reduction(| : acc)
+    for (size_t i = 0; i < data_size_; ++i) acc |= d[i];
+    return acc != 0;
+  }
+  bool none() const { return !any(); }
+
+  //! Bulk operations.  Both operands must have the same size().
+  Bitmask &operator|=(const Bitmask &O) {
+    word_type *a = words();
+    const word_type *b = O.words();
+#pragma omp simd
+    for (size_t i = 0; i < data_size_; ++i) a[i] |= b[i];
+    return *this;
+  }
+  Bitmask &operator&=(const Bitmask &O) {
+    word_type *a = words();
+    const word_type *b = O.words();
+#pragma omp simd
+    for (size_t i = 0; i < data_size_; ++i) a[i] &= b[i];
+    return *this;
+  }
+  Bitmask &operator^=(const Bitmask &O) {
+    word_type *a = words();
+    const word_type *b = O.words();
+#pragma omp simd
+    for (size_t i = 0; i < data_size_; ++i) a[i] ^= b[i];
+    return *this;
+  }
+  //! \brief Clear every bit that is set in O.
+  Bitmask &and_not(const Bitmask &O) {
+    word_type *a = words();
+    const word_type *b = O.words();
+#pragma omp simd
+    for (size_t i = 0; i < data_size_; ++i) a[i] &= ~b[i];
+    return *this;
+  }
+
+  bool operator==(const Bitmask &O) const {
+    return size_ == O.size_ &&
+           (data_size_ == 0 ||
+            std::memcmp(data_.get(), O.data_.get(), bytes()) == 0);
+  }
+  bool operator!=(const Bitmask &O) const { return !(*this == O); }
+
+  //! \brief Find the first set bit at position i or later.
+  //! \return Its position, or size() if there is none.
+  size_t find_next(size_t i) const { return find_next(i, size_); }
+
+  //! \brief Find the first set bit in [i, last).
+  //! \return Its position, or last if there is none.
+  size_t find_next(size_t i, size_t last) const {
+    if (i >= last) return last;
+    size_t w = i / word_bits;
+    const size_t last_word = (last - 1) / word_bits;
+    word_type bits = data_[w] & (~word_type(0) << (i % word_bits));
+    while (bits == 0) {
+      if (++w > last_word) return last;
+      bits = data_[w];
+    }
+    size_t found = w * word_bits + __builtin_ctzll(bits);
+    return found < last ? found : last;
+  }
+  size_t find_first() const { return find_next(0); }
+
+  //! \brief Call f(i) for every set bit i in increasing order.
+  template <typename Function>
+  void for_each(Function &&f) const {
+    for (size_t w = 0; w < data_size_; ++w) {
+      word_type bits = data_[w];
+      while (bits) {
+        f(w * word_bits + __builtin_ctzll(bits));
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  BaseTy *data() const { return reinterpret_cast<BaseTy *>(data_.get()); }
+  word_type *words() const {
+    return static_cast<word_type *>(
+        __builtin_assume_aligned(data_.get(), alignment));
+  }
+  size_t bytes() const { return data_size_ * sizeof(word_type); }
   size_t size() const { return size_; }
 
  private:
+  struct aligned_free {
+    void operator()(word_type *p) const { std::free(p); }
+  };
+  using storage_type = std::unique_ptr<word_type[], aligned_free>;
+
+  static constexpr word_type mask(size_t i) {
+    return word_type(1) << (i % word_bits);
+  }
+
+  //! The number of words for num_bits bits, rounded up to whole cache lines.
+  //! Like the original int layout it always keeps one spare word, so the
+  //! buffer is never smaller than the (num_bits / 32 + 1) ints that the
+  //! device kernels produce.
+  static size_t num_words(size_t num_bits) {
+    constexpr size_t line_words = alignment / sizeof(word_type);
+    size_t words = num_bits / word_bits + 1;
+    return (words + line_words - 1) / line_words * line_words;
+  }
+
+  static storage_type allocate(size_t words) {
+    if (words == 0) return storage_type(nullptr);
+    void *p = nullptr;
+    if (posix_memalign(&p, alignment, words * sizeof(word_type)) != 0)
+      throw std::bad_alloc();
+    return storage_type(static_cast<word_type *>(p));
+  }
+
   size_t size_;
   size_t data_size_;
-  std::unique_ptr<BaseTy[]> data_;
+  storage_type data_;
 };
 
 }  // namespace ripples
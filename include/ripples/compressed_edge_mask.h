@@ -0,0 +1,197 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_COMPRESSED_EDGE_MASK_H
+#define RIPPLES_COMPRESSED_EDGE_MASK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ripples/bitmask.h"
+
+namespace ripples {
+
+//! \brief A live-edge sample stored dense or as its sorted live edges.
+//!
+//! The representation is chosen per sample: the sorted list of live edge
+//! numbers is kept when it is smaller than the bitmask, that is when less
+//! than about one edge in 32 is live, and the bitmask otherwise.  The list
+//! comes with the position of the first live edge of every block of
+//! block_bits edges, so that finding the live edges of a vertex is a short
+//! scan instead of a binary search over the whole sample.  Traversals go
+//! through for_each_live_edge() and next_live_edge(), which only visit the
+//! live edges of a vertex in both representations.
+class CompressedEdgeMask {
+ public:
+  using index_type = uint32_t;
+  //! The number of edges covered by an entry of the block index.
+  static constexpr size_t block_bits = 256;
+
+  CompressedEdgeMask() : size_(0), sparse_(false) {}
+
+  //! \brief Compress a dense sample.
+  //!
+  //! \param M The dense sample.
+  explicit CompressedEdgeMask(const Bitmask<int> &M)
+      : size_(M.size()), sparse_(false) {
+    const size_t live = M.popcount();
+    const size_t num_blocks = size_ / block_bits + 1;
+    if (size_ <= std::numeric_limits<index_type>::max() &&
+        (live + num_blocks + 1) * sizeof(index_type) < M.bytes()) {
+      sparse_ = true;
+      live_.reserve(live);
+      block_.reserve(num_blocks + 1);
+      for (size_t e = M.find_first(); e < size_; e = M.find_next(e + 1)) {
+        while (block_.size() <= e / block_bits) block_.push_back(live_.size());
+        live_.push_back(e);
+      }
+      while (block_.size() <= num_blocks) block_.push_back(live_.size());
+    } else {
+      dense_ = M;
+    }
+  }
+
+  bool get(size_t i) const {
+    if (!sparse_) return dense_.get(i);
+    auto itr = lower_bound(i);
+    return itr != live_.end() && *itr == i;
+  }
+
+  //! \brief The first live edge in [e, last), or last if there is none.
+  size_t next_live(size_t e, size_t last) const {
+    if (!sparse_) return dense_.find_next(e, last);
+    if (e >= last) return last;
+    auto itr = lower_bound(e);
+    return itr != live_.end() && *itr < last ? *itr : last;
+  }
+
+  //! \brief Call f(e) for every live edge e in [first, last).
+  template <typename Function>
+  void for_each_live(size_t first, size_t last, Function &&f) const {
+    if (!sparse_) {
+      for (size_t e = dense_.find_next(first, last); e < last;
+           e = dense_.find_next(e + 1, last))
+        f(e);
+      return;
+    }
+    if (first >= last) return;
+    for (auto itr = lower_bound(first); itr != live_.end() && *itr < last;
+         ++itr)
+      f(*itr);
+  }
+
+  //! \brief Store the sample in a bitmask, e.g., to copy it to a device.
+  void materialize(Bitmask<int> &M) const {
+    if (!sparse_) {
+      M = dense_;
+      return;
+    }
+    if (M.size() != size()) M = Bitmask<int>(size());
+    M.clear();
+    for (index_type e : live_) M.set(e);
+  }
+
+  size_t size() const { return size_; }
+  //! Whether the sample is stored as a list of live edges.
+  bool sparse() const { return sparse_; }
+  //! The memory held by the sample in bytes.
+  size_t bytes() const {
+    return sparse_ ? (live_.capacity() + block_.capacity()) * sizeof(index_type)
+                   : dense_.bytes();
+  }
+
+ private:
+  using live_iterator = std::vector<index_type>::const_iterator;
+
+  //! The first live edge not smaller than e, found from its block.
+  live_iterator lower_bound(size_t e) const {
+    auto itr = live_.begin() + block_[e / block_bits];
+    auto end = live_.begin() + block_[e / block_bits + 1];
+    while (itr != end && *itr < e) ++itr;
+    return itr;
+  }
+
+  size_t size_;
+  bool sparse_;
+  Bitmask<int> dense_;
+  std::vector<index_type> live_;
+  std::vector<index_type> block_;
+};
+
+//! \brief The first live edge of M in [e, last), or last if there is none.
+template <typename GraphMaskTy>
+size_t next_live_edge(const GraphMaskTy &M, size_t e, size_t last) {
+  while (e < last && !M.get(e)) ++e;
+  return e;
+}
+
+template <typename BaseTy>
+size_t next_live_edge(const Bitmask<BaseTy> &M, size_t e, size_t last) {
+  return M.find_next(e, last);
+}
+
+inline size_t next_live_edge(const CompressedEdgeMask &M, size_t e,
+                             size_t last) {
+  return M.next_live(e, last);
+}
+
+//! \brief Call f(e) for every live edge e of M in [first, last).
+template <typename GraphMaskTy, typename Function>
+void for_each_live_edge(const GraphMaskTy &M, size_t first, size_t last,
+                        Function &&f) {
+  for (size_t e = next_live_edge(M, first, last); e < last;
+       e = next_live_edge(M, e + 1, last))
+    f(e);
+}
+
+template <typename Function>
+void for_each_live_edge(const CompressedEdgeMask &M, size_t first,
+                        size_t last, Function &&f) {
+  M.for_each_live(first, last, f);
+}
+
+}  // namespace ripples
+
+#endif  // RIPPLES_COMPRESSED_EDGE_MASK_H
@@ -0,0 +1,122 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_COUNTER_RNG_H
+#define RIPPLES_COUNTER_RNG_H
+
+#include <cstdint>
+
+namespace ripples {
+
+//! \brief The SplitMix64 finalizer.
+inline uint64_t splitmix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+//! \brief The key of one world, from the seed of all the worlds.
+inline uint64_t world_key(uint64_t key, uint64_t world) {
+  return splitmix64(key ^ splitmix64(world));
+}
+
+//! \brief Counter-based uniform random number in [0, 1).
+//!
+//! The value is a pure function of (world key, counter), so that every
+//! evaluation of the same world sees the same random choices without storing
+//! them.
+inline double counter_uniform(uint64_t world_key, uint64_t counter) {
+  return (splitmix64(world_key ^ counter) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//! \brief A keyed pseudo-random permutation of [0, n).
+//!
+//! A four-round balanced Feistel network over the smallest even number of
+//! bits covering n, walked until the image falls back in [0, n).  It visits
+//! n items in random order without storing the order.
+class CounterPermutation {
+ public:
+  //! \brief Constructor.
+  //!
+  //! \param n The number of items.
+  //! \param key The seed of the permutation.
+  CounterPermutation(uint64_t n, uint64_t key) : n_(n), half_bits_(1) {
+    while (half_bits_ < 32 && (uint64_t(1) << (2 * half_bits_)) < n)
+      ++half_bits_;
+    mask_ = (uint64_t(1) << half_bits_) - 1;
+    for (uint64_t r = 0; r < num_rounds; ++r) round_key_[r] = world_key(key, r);
+  }
+
+  //! \brief The item at position i of the permutation.
+  uint64_t operator()(uint64_t i) const {
+    do {
+      i = encrypt(i);
+    } while (i >= n_);
+    return i;
+  }
+
+  uint64_t size() const { return n_; }
+
+ private:
+  static constexpr uint64_t num_rounds = 4;
+
+  uint64_t encrypt(uint64_t x) const {
+    uint64_t l = x >> half_bits_;
+    uint64_t r = x & mask_;
+    for (uint64_t round = 0; round < num_rounds; ++round) {
+      uint64_t t = l ^ (splitmix64(round_key_[round] ^ r) & mask_);
+      l = r;
+      r = t;
+    }
+    return (l << half_bits_) | r;
+  }
+
+  uint64_t n_;
+  uint64_t half_bits_;
+  uint64_t mask_;
+  uint64_t round_key_[num_rounds];
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_COUNTER_RNG_H
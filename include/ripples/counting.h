@@ -45,6 +45,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 #include <omp.h>
 
@@ -97,6 +98,78 @@ void CountOccurrencies(InItr in_begin, InItr in_end, OutItr out_begin,
 }
 
 
+//! \brief Count the occurrencies of vertices in the RRR sets on NUMA systems.
+//!
+//! The RRR sets are split in one contiguous block per NUMA domain.  The
+//! threads of a domain count the vertices of their block in counters local to
+//! the domain, which are then summed into the output.  Threads are bound with
+//! proc_bind(spread): OMP_PLACES should describe the NUMA domains.
+//!
+//! \tparam InItr The input sequence iterator type.
+//! \tparam OutItr The output sequence iterator type.
+//!
+//! \param in_begin The begin of the sequence of RRR sets.
+//! \param in_end The end of the sequence of RRR sets.
+//! \param out_begin The begin of the sequence storing the counters for each
+//! vertex.
+//! \param out_end The end of the sequence storing the counters for each vertex.
+//! \param num_threads The number of threads.
+//! \param num_domains The number of NUMA domains.
+template <typename InItr, typename OutItr>
+void CountOccurrencies(InItr in_begin, InItr in_end, OutItr out_begin,
+                       OutItr out_end, size_t num_threads, size_t num_domains) {
+  if (num_domains <= 1 || num_threads < num_domains) {
+    CountOccurrencies(in_begin, in_end, out_begin, out_end, num_threads);
+    return;
+  }
+
+  using rrr_set_type = typename std::iterator_traits<InItr>::value_type;
+  using vertex_type = typename rrr_set_type::value_type;
+  using counter_type = typename std::iterator_traits<OutItr>::value_type;
+
+  size_t num_elements = std::distance(out_begin, out_end);
+  size_t num_sets = std::distance(in_begin, in_end);
+  std::vector<std::vector<counter_type>> local_counters(num_domains);
+
+#pragma omp parallel num_threads(num_threads) proc_bind(spread)
+  {
+    size_t rank = omp_get_thread_num(), numthreads = omp_get_num_threads();
+    // The team may be smaller than requested: every domain must still have
+    // a thread, so that all the RRR sets are counted.
+    size_t domains = std::min(num_domains, numthreads);
+    size_t domain = rank * domains / numthreads;
+    size_t first_thread = (domain * numthreads + domains - 1) / domains;
+    size_t last_thread = ((domain + 1) * numthreads + domains - 1) / domains;
+    size_t domain_rank = rank - first_thread;
+    size_t domain_threads = last_thread - first_thread;
+
+    // First touch from within the domain.
+    if (domain_rank == 0) local_counters[domain].assign(num_elements, 0);
+#pragma omp barrier
+
+    auto &counters = local_counters[domain];
+    vertex_type low = num_elements * domain_rank / domain_threads,
+                high = num_elements * (domain_rank + 1) / domain_threads;
+
+    auto first = in_begin + num_sets * domain / domains;
+    auto last = in_begin + num_sets * (domain + 1) / domains;
+    for (auto itr = first; itr != last; ++itr) {
+      auto begin = std::lower_bound(itr->begin(), itr->end(), low);
+      auto end = std::upper_bound(begin, itr->end(), high - 1);
+      std::for_each(begin, end, [&](const vertex_type v) { counters[v] += 1; });
+    }
+
+#pragma omp barrier
+#pragma omp for schedule(static)
+    for (size_t v = 0; v < num_elements; ++v) {
+      counter_type sum = 0;
+      for (size_t d = 0; d < domains; ++d) sum += local_counters[d][v];
+      *(out_begin + v) += sum;
+    }
+  }
+}
+
+
 //! \brief Count the occurrencies of vertices in the RRR sets.
 //!
 //! \tparam InItr The input sequence iterator type.
@@ -0,0 +1,237 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_CRN_EVALUATION_H
+#define RIPPLES_CRN_EVALUATION_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ripples/counter_rng.h"
+#include "ripples/diffusion_simulation.h"
+
+namespace ripples {
+
+//! \brief Evaluate many seed sets on the same sampled worlds.
+//!
+//! A world is drawn by a counter-based generator: under IC an edge is live
+//! when the number drawn for (world, edge) is below its weight, under LT the
+//! threshold of a vertex is the number drawn for (world, vertex).  Since
+//! worlds are never stored, all seed sets are evaluated on identical worlds
+//! (common random numbers), and their differences have much lower variance
+//! than with independent simulations.
+//!
+//! Under IC one BFS per world serves all the seed sets: every vertex holds a
+//! bitmask of the seed sets that reach it, and the newly reached bits are
+//! pushed along the live edges.  Under LT activations depend on the weight
+//! accumulated by each seed set, so the seed sets are pushed one at a time
+//! against the shared thresholds.
+//!
+//! \tparam GraphTy The type of the input graph, in forward direction.
+template <typename GraphTy>
+class CRNEvaluator {
+  using vertex_type = typename GraphTy::vertex_type;
+  using edge_weight_type = typename GraphTy::edge_type::edge_weight;
+
+ public:
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  //! \param key The seed of the worlds.
+  //! \param model_tag The diffusion model.
+  CRNEvaluator(const GraphTy &G, uint64_t key, const independent_cascade_tag &)
+      : G_(G), key_(key), linear_threshold_(false) {}
+
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  //! \param key The seed of the worlds.
+  //! \param model_tag The diffusion model.
+  CRNEvaluator(const GraphTy &G, uint64_t key, const linear_threshold_tag &)
+      : G_(G),
+        key_(key),
+        linear_threshold_(true),
+        accumulated_(G.num_nodes(), 0),
+        active_(G.num_nodes(), false) {}
+
+  //! \brief Evaluate the seed sets in one world.
+  //!
+  //! \param seed_sets The seed sets, with internal vertex IDs.
+  //! \param world The index of the world.
+  //! \return the number of vertices activated by every seed set.
+  template <typename SeedSetsTy>
+  std::vector<size_t> evaluate(const SeedSetsTy &seed_sets, uint64_t world) {
+    if (linear_threshold_) {
+      std::vector<size_t> activated;
+      for (auto &seeds : seed_sets)
+        activated.push_back(evaluate_lt(seeds.begin(), seeds.end(), world));
+      return activated;
+    }
+
+    uint64_t key = world_key(key_, world);
+    size_t words = (seed_sets.size() + 63) / 64;
+    if (reached_.size() != G_.num_nodes() * words) {
+      words_ = words;
+      reached_.assign(G_.num_nodes() * words, 0);
+      fresh_.assign(G_.num_nodes() * words, 0);
+      pending_.assign(words, 0);
+    }
+
+    touched_.clear();
+    frontier_.clear();
+    for (size_t s = 0; s < seed_sets.size(); ++s) {
+      uint64_t bit = uint64_t(1) << (s % 64);
+      for (vertex_type v : seed_sets[s]) {
+        if (!any(reached_, v)) touched_.push_back(v);
+        if (!any(fresh_, v)) frontier_.push_back(v);
+        word(reached_, v, s / 64) |= bit;
+        word(fresh_, v, s / 64) |= bit;
+      }
+    }
+
+    // A vertex waits in the queue while it collects the seed sets arriving
+    // from several parents, and is expanded once for all of them.
+    for (size_t head = 0; head < frontier_.size(); ++head) {
+      vertex_type v = frontier_[head];
+      for (size_t w = 0; w < words_; ++w) {
+        pending_[w] = word(fresh_, v, w);
+        word(fresh_, v, w) = 0;
+      }
+      for (auto &e : G_.neighbors(v)) {
+        vertex_type u = e.vertex;
+        // Draw the edge only when it would bring new seed sets to u.
+        bool covered = true;
+        for (size_t w = 0; w < words_ && covered; ++w)
+          covered = (pending_[w] & ~word(reached_, u, w)) == 0;
+        if (covered || !live(e, key)) continue;
+
+        if (!any(reached_, u)) touched_.push_back(u);
+        if (!any(fresh_, u)) frontier_.push_back(u);
+        for (size_t w = 0; w < words_; ++w) {
+          uint64_t bits = pending_[w] & ~word(reached_, u, w);
+          word(reached_, u, w) |= bits;
+          word(fresh_, u, w) |= bits;
+        }
+      }
+    }
+
+    std::vector<size_t> activated(seed_sets.size(), 0);
+    for (vertex_type v : touched_)
+      for (size_t w = 0; w < words_; ++w) {
+        for (uint64_t bits = word(reached_, v, w); bits != 0;
+             bits &= bits - 1)
+          ++activated[w * 64 + __builtin_ctzll(bits)];
+        word(reached_, v, w) = 0;
+      }
+    return activated;
+  }
+
+ private:
+  template <typename EdgeTy>
+  bool live(const EdgeTy &e, uint64_t key) const {
+    return counter_uniform(key, &e - G_.csr_edges()) < e.weight;
+  }
+
+  template <typename Iterator>
+  size_t evaluate_lt(Iterator begin, Iterator end, uint64_t world) {
+    uint64_t key = world_key(key_, world);
+    frontier_.clear();
+    for (auto itr = begin; itr != end; ++itr) {
+      if (active_[*itr]) continue;
+      active_[*itr] = true;
+      frontier_.push_back(*itr);
+    }
+    touched_.assign(frontier_.begin(), frontier_.end());
+    size_t num_active = frontier_.size();
+
+    while (!frontier_.empty()) {
+      next_frontier_.clear();
+      for (vertex_type v : frontier_) {
+        for (auto &e : G_.neighbors(v)) {
+          vertex_type u = e.vertex;
+          if (active_[u]) continue;
+          if (accumulated_[u] == 0) touched_.push_back(u);
+          accumulated_[u] += e.weight;
+          if (accumulated_[u] >= counter_uniform(key, u)) {
+            active_[u] = true;
+            next_frontier_.push_back(u);
+          }
+        }
+      }
+      num_active += next_frontier_.size();
+      frontier_.swap(next_frontier_);
+    }
+
+    for (vertex_type v : touched_) {
+      accumulated_[v] = 0;
+      active_[v] = false;
+    }
+    return num_active;
+  }
+
+  uint64_t &word(std::vector<uint64_t> &bits, vertex_type v, size_t w) {
+    return bits[v * words_ + w];
+  }
+
+  bool any(std::vector<uint64_t> &bits, vertex_type v) {
+    for (size_t w = 0; w < words_; ++w)
+      if (word(bits, v, w) != 0) return true;
+    return false;
+  }
+
+  const GraphTy &G_;
+  uint64_t key_;
+  bool linear_threshold_;
+  std::vector<edge_weight_type> accumulated_;
+  std::vector<bool> active_;
+  size_t words_{0};
+  std::vector<uint64_t> reached_;
+  std::vector<uint64_t> fresh_;
+  std::vector<uint64_t> pending_;
+  std::vector<vertex_type> touched_;
+  std::vector<vertex_type> frontier_;
+  std::vector<vertex_type> next_frontier_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_CRN_EVALUATION_H
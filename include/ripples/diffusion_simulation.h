@@ -44,7 +44,7 @@
 #define RIPPLES_DIFFUSION_SIMULATION_H
 
 #include <algorithm>
-#include <set>
+#include <utility>
 #include <vector>
 
 #include "trng/uniform01_dist.hpp"
@@ -58,6 +58,96 @@ struct independent_cascade_tag {};
 //! \brief Type-tag for the Linear Threshold Model.
 struct linear_threshold_tag {};
 
+//! \brief Linear Threshold simulation with reusable scratch space.
+//!
+//! When a vertex activates, it pushes its outgoing weights to the
+//! accumulators of its neighbors, so a vertex is examined only when one of
+//! its in-neighbors activates and the in-neighbors are never rescanned.  The
+//! thresholds are drawn the first time a vertex receives weight.  The
+//! scratch arrays are flat and only the entries touched by a replica are
+//! reset, so one simulator per thread can run any number of replicas.
+//!
+//! \tparam GraphTy The type of the input graph.
+template <typename GraphTy>
+class LTSimulator {
+  using vertex_type = typename GraphTy::vertex_type;
+  using edge_weight_type = typename GraphTy::edge_type::edge_weight;
+
+ public:
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  explicit LTSimulator(const GraphTy &G)
+      : G_(G),
+        accumulated_(G.num_nodes(), 0),
+        threshold_(G.num_nodes(), -1),
+        active_(G.num_nodes(), false) {}
+
+  //! \brief Run one replica.
+  //!
+  //! Vertices activated while processing a level join the next one, which
+  //! reproduces the synchronous rounds of the model.
+  //!
+  //! \param begin The start of the sequence of seeds.
+  //! \param end The end of the sequence of seeds.
+  //! \param generator The random number generator.
+  //! \return a pair (A, S), where A is the number of activated nodes and S
+  //! is the number of steps the simulation run.
+  template <typename Iterator, typename PRNG>
+  std::pair<size_t, size_t> simulate(Iterator begin, Iterator end,
+                                     PRNG &generator) {
+    trng::uniform01_dist<edge_weight_type> thresholds_generator;
+
+    frontier_.clear();
+    for (auto itr = begin; itr != end; ++itr) {
+      if (active_[*itr]) continue;
+      active_[*itr] = true;
+      frontier_.push_back(*itr);
+    }
+    touched_.assign(frontier_.begin(), frontier_.end());
+    size_t num_active = frontier_.size();
+
+    size_t level = 0;
+    while (!frontier_.empty()) {
+      next_frontier_.clear();
+      for (vertex_type v : frontier_) {
+        for (auto &e : G_.neighbors(v)) {
+          vertex_type u = e.vertex;
+          if (active_[u]) continue;
+          if (threshold_[u] < 0) {
+            threshold_[u] = thresholds_generator(generator);
+            touched_.push_back(u);
+          }
+          accumulated_[u] += e.weight;
+          if (accumulated_[u] >= threshold_[u]) {
+            active_[u] = true;
+            next_frontier_.push_back(u);
+          }
+        }
+      }
+      num_active += next_frontier_.size();
+      frontier_.swap(next_frontier_);
+      ++level;
+    }
+
+    for (vertex_type v : touched_) {
+      accumulated_[v] = 0;
+      threshold_[v] = -1;
+      active_[v] = false;
+    }
+    return std::make_pair(num_active, level);
+  }
+
+ private:
+  const GraphTy &G_;
+  std::vector<edge_weight_type> accumulated_;
+  std::vector<edge_weight_type> threshold_;
+  std::vector<bool> active_;
+  std::vector<vertex_type> touched_;
+  std::vector<vertex_type> frontier_;
+  std::vector<vertex_type> next_frontier_;
+};
+
 namespace impl {
 
 //! \brief Simulate using the Independent Cascade Model.
@@ -108,9 +198,6 @@ auto run_simulation(const GraphTy &G, Iterator begin, Iterator end,
       ++level;
     }
   }
-  for (int i = 0; i != visited.size(); ++i) {
-    if(visited[i]) std::cout << i << ",";
-  }
   return std::make_pair(std::count(visited.begin(), visited.end(), true),
                         level);
 }
@@ -130,53 +217,8 @@ auto run_simulation(const GraphTy &G, Iterator begin, Iterator end,
 template <typename GraphTy, typename Iterator, typename PRNG>
 auto run_simulation(const GraphTy &G, Iterator begin, Iterator end,
                     PRNG &generator, const linear_threshold_tag &) {
-  using vertex_type = typename GraphTy::vertex_type;
-  using edge_type = typename GraphTy::edge_type;
-  using edge_weight_type = typename edge_type::edge_weight;
-
-  auto transposedG = G.get_transpose();
-
-  trng::uniform01_dist<edge_weight_type> thresholds_generator;
-
-  std::vector<edge_weight_type> thresholds(G.num_nodes());
-  std::generate(
-      thresholds.begin(), thresholds.end(),
-      [&]() -> edge_weight_type { return thresholds_generator(generator); });
-
-  std::set<vertex_type> active(begin, end);
-  std::set<vertex_type> tobe_activated;
-
-  size_t level(0);
-  do {
-    std::set<vertex_type> tobe_processed;
-    tobe_activated.clear();
-    for (auto v : active) {
-      for (auto u : G.neighbors(v)) {
-        if (active.find(u.vertex) == active.end()) {
-          tobe_processed.insert(u.vertex);
-        }
-      }
-    }
-
-    for (auto v : tobe_processed) {
-      edge_weight_type total(0);
-
-      for (auto u : transposedG.neighbors(v)) {
-        if (active.find(u.vertex) != active.end()) {
-          total += u.weight;
-        }
-      }
-
-      if (total >= thresholds[v]) {
-        tobe_activated.insert(v);
-      }
-    }
-
-    active.insert(tobe_activated.begin(), tobe_activated.end());
-    ++level;
-  } while (!tobe_activated.empty());
-
-  return std::make_pair(active.size(), level);
+  LTSimulator<GraphTy> simulator(G);
+  return simulator.simulate(begin, end, generator);
 }
 
 }  // namespace impl
@@ -171,7 +171,8 @@ template <typename GraphTy, typename ConfTy, typename RRRset>
 auto FindMostInfluentialSet(const GraphTy &G, const ConfTy &CFG,
                             std::vector<RRRset> &RRRsets,
                             IMMExecutionRecord &record, bool enableGPU,
-                            omp_parallel_tag &&ex_tag) {
+                            omp_parallel_tag &&ex_tag,
+                            const std::vector<uint32_t> *coverage = nullptr) {
   size_t num_gpu = 0;
   size_t num_max_cpu = 0;
 #pragma omp single
@@ -184,10 +185,82 @@ auto FindMostInfluentialSet(const GraphTy &G, const ConfTy &CFG,
     num_gpu = std::min(cuda_num_devices(), CFG.seed_select_max_gpu_workers);
   }
 #endif
-  StreamingFindMostInfluential<GraphTy> SE(G, RRRsets, num_max_cpu, num_gpu);
+  StreamingFindMostInfluential<GraphTy> SE(G, RRRsets, num_max_cpu, num_gpu,
+                                           CFG.numa_domains, coverage);
   return SE.find_most_influential_set(CFG.k);
 }
 
+//! \brief Attribute RRR sets to the first seed, in selection order, they
+//! contain.
+//!
+//! \tparam SetAccessTy Callable returning the [begin, end) pointers to the
+//! vertices of the i-th RRR set.
+//!
+//! \param num_sets The number of RRR sets.
+//! \param set The accessor to the RRR sets.
+//! \param rank The position of each vertex in the seed set, or the size of the
+//! seed set for vertices that are not seeds.
+//! \param covered The number of RRR sets attributed to each seed.
+//! \param num_threads The number of threads.
+template <typename SetAccessTy>
+void CountFirstCoveringSeed(size_t num_sets, SetAccessTy set,
+                            const std::vector<uint32_t> &rank,
+                            std::vector<size_t> &covered, size_t num_threads) {
+  size_t k = covered.size();
+#pragma omp parallel num_threads(num_threads)
+  {
+    std::vector<size_t> local(k + 1, 0);
+#pragma omp for schedule(dynamic, 256)
+    for (size_t i = 0; i < num_sets; ++i) {
+      auto range = set(i);
+      uint32_t first = k;
+      for (auto itr = range.first; itr != range.second; ++itr)
+        first = std::min(first, rank[*itr]);
+      ++local[first];
+    }
+#pragma omp critical
+    for (size_t j = 0; j < k; ++j) covered[j] += local[j];
+  }
+}
+
+//! \brief The fraction of RRR sets covered by every prefix of a seed set.
+//!
+//! Greedy selection picks seeds in order, so the first j seeds of a seed set
+//! of size k are the seed set of size j.
+//!
+//! \param G The input graph.
+//! \param RRRsets The RRR sets.
+//! \param seeds The seeds in selection order.
+//! \param num_threads The number of threads.
+//!
+//! \return the fraction of RRR sets covered by the first j + 1 seeds at
+//! position j.
+template <typename GraphTy, typename RRRset>
+std::vector<double> PrefixCoverage(
+    const GraphTy &G, const std::vector<RRRset> &RRRsets,
+    const std::vector<typename GraphTy::vertex_type> &seeds,
+    size_t num_threads) {
+  std::vector<uint32_t> rank(G.num_nodes(), seeds.size());
+  for (size_t j = 0; j < seeds.size(); ++j) rank[seeds[j]] = j;
+
+  std::vector<size_t> covered(seeds.size(), 0);
+  CountFirstCoveringSeed(
+      RRRsets.size(),
+      [&](size_t i) {
+        return std::make_pair(RRRsets[i].data(),
+                              RRRsets[i].data() + RRRsets[i].size());
+      },
+      rank, covered, num_threads);
+
+  std::vector<double> fractions(seeds.size());
+  size_t total = 0;
+  for (size_t j = 0; j < seeds.size(); ++j) {
+    total += covered[j];
+    fractions[j] = double(total) / RRRsets.size();
+  }
+  return fractions;
+}
+
 #if RIPPLES_ENABLE_CUDA
 template <typename Itr>
 void MoveRRRSets(Itr in_begin, Itr in_end, uint32_t *d_rrr_index,
@@ -45,6 +45,7 @@
 
 #include <algorithm>
 #include <queue>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -77,8 +78,15 @@ using RRRsetAllocator = libmemkind::static_kind::allocator<vertex_type>;
 template<typename vertex_type>
 using RRRsetAllocator = metall::manager::allocator_type<vertex_type>;
 
+//! The directory backing the Metall datastore, set before the first use.
+inline std::string &metall_directory() {
+  static std::string directory("/tmp/ripples");
+  return directory;
+}
+
 metall::manager &metall_manager_instance() {
-  static metall::manager manager(metall::create_only, "/tmp/ripples");
+  static metall::manager manager(metall::create_only,
+                                 metall_directory().c_str());
   return manager;
 }
 
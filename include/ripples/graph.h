@@ -45,6 +45,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <iterator>
 #include <map>
 #include <numeric>
 #include <vector>
@@ -249,8 +250,7 @@ class Graph {
 
 #pragma omp parallel for
     for (size_t i = 0; i < numNodes + 1; ++i) {
-      index[i] = edges + (reinterpret_cast<uint64_t>(O.index[i]) -
-                          reinterpret_cast<uint64_t>(O.index));
+      index[i] = edges + std::distance(O.edges, O.index[i]);
     }
   }
 
@@ -269,8 +269,7 @@ class Graph {
 
 #pragma omp parallel for
     for (size_t i = 0; i < numNodes + 1; ++i) {
-      index[i] = edges + (reinterpret_cast<uint64_t>(O.index[i]) -
-                          reinterpret_cast<uint64_t>(O.index));
+      index[i] = edges + std::distance(O.edges, O.index[i]);
     }
   }
 
@@ -45,7 +45,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <memory>
 #include <queue>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -58,6 +60,10 @@
 #include "ripples/diffusion_simulation.h"
 #include "ripples/graph.h"
 #include "ripples/hill_climbing_engine.h"
+#include "ripples/compressed_edge_mask.h"
+#include "ripples/implicit_edge_mask.h"
+#include "ripples/sketch_selection_engine.h"
+#include "ripples/vectorized_ic_sampler.h"
 
 #include "omp.h"
 
@@ -68,6 +74,16 @@ struct HillClimbingConfiguration : public AlgorithmConfiguration {
   size_t samples{10000};
   size_t streaming_workers{0};
   size_t streaming_gpu_workers{0};
+  bool scc_counting{false};
+  size_t sketch_size{64};
+  size_t exact_reachability_limit{4096};
+  bool implicit_samples{false};
+  bool vectorized_sampling{false};
+  bool compressed_samples{false};
+  bool lazy{false};
+  size_t lazy_batch{8};
+  std::string counting_parallelism{"auto"};
+  bool sketch_selection{false};
 
   //! \brief Add command line options to configure the Hill Climbing Algorithm.
   //!
@@ -81,6 +97,59 @@ struct HillClimbingConfiguration : public AlgorithmConfiguration {
            "--streaming-gpu-workers", streaming_gpu_workers,
            "The number of GPU workers for the CPU+GPU streaming engine.")
         ->group("Streaming-Engine Options");
+    app.add_flag("--scc-counting", scc_counting,
+                 "Count marginal gains over the SCC condensation of every "
+                 "sample.")
+        ->group("Algorithm Options");
+    app.add_option("--sketch-size", sketch_size,
+                   "The size of the bottom-k reachability sketches used by "
+                   "--scc-counting and --sketch-selection.")
+        ->group("Algorithm Options");
+    app.add_flag("--sketch-selection", sketch_selection,
+                 "Approximate the greedy selection with combined bottom-k "
+                 "reachability sketches over all the samples (SKIM).")
+        ->group("Algorithm Options");
+    app.add_option("--exact-reachability-limit", exact_reachability_limit,
+                   "The largest condensation counted exactly by "
+                   "--scc-counting; larger ones use sketches.")
+        ->group("Algorithm Options");
+    app.add_flag("--implicit-samples", implicit_samples,
+                 "Store every sample as a key and recompute the live edges "
+                 "on demand instead of storing edge bitmasks.")
+        ->group("Algorithm Options");
+    app.add_flag("--vectorized-sampling", vectorized_sampling,
+                 "Sample the IC live edges 64 at a time, splitting every "
+                 "sample by edge range across the workers.")
+        ->group("Algorithm Options");
+    app.add_flag("--compressed-samples", compressed_samples,
+                 "Store every sample as the sorted list of its live edges "
+                 "when that is smaller than its bitmask.")
+        ->group("Algorithm Options");
+    app.add_flag("--lazy", lazy,
+                 "Lazy-forward (CELF) selection: after the first step only "
+                 "the candidates reaching the top of the queue are counted.")
+        ->group("Algorithm Options");
+    app.add_option("--lazy-batch", lazy_batch,
+                   "The number of candidates counted together by --lazy.")
+        ->group("Algorithm Options");
+    app.add_option("--counting-parallelism", counting_parallelism,
+                   "How the CPU workers share a counting pass: "
+                   "samples|vertices|auto.")
+        ->group("Streaming-Engine Options");
+  }
+
+  //! \brief The options of the counting workers.
+  HCCountingOptions counting_options() const {
+    HCCountingOptions options;
+    options.scc_counting = scc_counting;
+    options.sketch_size = sketch_size;
+    options.exact_reachability_limit = exact_reachability_limit;
+    options.lazy = lazy;
+    options.lazy_batch = std::max<size_t>(lazy_batch, 1);
+    options.parallelism = counting_parallelism;
+    // The cache would take more memory than these samples avoid storing.
+    options.frontier_cache = !implicit_samples && !compressed_samples;
+    return options;
   }
 };
 
@@ -103,17 +172,69 @@ struct HillClimbingExecutionRecord {
   std::vector<std::vector<std::vector<ex_time_ms>>> BuildCountersTasks;
   //! Network Communication
   std::vector<ex_time_ms> NetworkReductions;
+  //! Estimated marginal gain of every seed of the sketch selection.
+  std::vector<double> EstimatedGains;
+  //! Memory held by the samples and the cached frontiers in bytes.
+  size_t SampleBytes{0};
+  //! Number of candidates counted at every step of the seed selection.
+  std::vector<size_t> CandidatesPerStep;
   //! Seed Selection time.
   ex_time_ms SeedSelection;
   //! Total execution time.
   ex_time_ms Total;
 };
 
+//! \brief Sample [B, E) as the samples first_sample, first_sample + 1, ...
+//! of the worlds with the given key.
+template <typename GraphTy, typename ItrTy>
+void VectorizedSample(const VectorizedICSampler<GraphTy> &sampler,
+                      uint64_t key, size_t first_sample, ItrTy B, ItrTy E) {
+  constexpr size_t block_words = 1024;
+  const size_t num_words = sampler.num_words();
+  const size_t num_blocks = (num_words + block_words - 1) / block_words;
+  const size_t num_tasks = std::distance(B, E) * num_blocks;
+
+#pragma omp parallel for schedule(dynamic)
+  for (size_t t = 0; t < num_tasks; ++t) {
+    size_t s = t / num_blocks;
+    size_t first = (t % num_blocks) * block_words;
+    size_t last = std::min(first + block_words, num_words);
+    sampler.sample(world_key(key, first_sample + s), first, last, B[s]);
+  }
+}
+
+//! \brief Sample the IC live edges a word at a time.
+//!
+//! Every sample is cut into blocks of words and the (sample, block) pairs are
+//! distributed over the threads, so that the samples of a large graph are
+//! split across the workers even when there are fewer samples than threads.
+template <typename GraphTy, typename GeneratorTy, typename ConfTy>
+auto VectorizedSampleFrom(GraphTy &G, ConfTy &CFG, GeneratorTy &gen,
+                          HillClimbingExecutionRecord &record) {
+  using edge_mask = Bitmask<int>;
+  std::vector<edge_mask> samples(CFG.samples, edge_mask(G.num_edges()));
+  auto start = std::chrono::high_resolution_clock::now();
+
+  VectorizedICSampler<GraphTy> sampler(G);
+  VectorizedSample(sampler, gen(), 0, samples.begin(), samples.end());
+
+  auto end = std::chrono::high_resolution_clock::now();
+  record.Sampling = end - start;
+  record.SampleBytes =
+      samples.empty() ? 0 : samples.size() * samples.front().bytes();
+  return samples;
+}
+
 template <typename GraphTy, typename GeneratorTy, typename diff_model_tag,
           typename ConfTy>
 auto SampleFrom(GraphTy &G, ConfTy &CFG, GeneratorTy &gen,
                 HillClimbingExecutionRecord &record,
                 diff_model_tag &&diff_model) {
+  if (CFG.vectorized_sampling &&
+      std::is_same<typename std::decay<diff_model_tag>::type,
+                   independent_cascade_tag>::value)
+    return VectorizedSampleFrom(G, CFG, gen, record);
+
   using vertex_type = typename GraphTy::vertex_type;
   using edge_mask = Bitmask<int>;
   std::vector<edge_mask> samples(CFG.samples,
@@ -126,18 +247,112 @@ auto SampleFrom(GraphTy &G, ConfTy &CFG, GeneratorTy &gen,
   SE.exec(samples.begin(), samples.end(), record.SamplingTasks);
   auto end = std::chrono::high_resolution_clock::now();
   record.Sampling = end - start;
+  record.SampleBytes =
+      samples.empty() ? 0 : samples.size() * samples.front().bytes();
+  return samples;
+}
+
+//! \brief Sample in chunks and keep every sample in the smaller of its dense
+//! and sparse representations.
+//!
+//! Only one chunk of dense samples is alive at any time.
+template <typename GraphTy, typename GeneratorTy, typename diff_model_tag,
+          typename ConfTy>
+auto CompressedSampleFrom(GraphTy &G, ConfTy &CFG, GeneratorTy &gen,
+                          HillClimbingExecutionRecord &record,
+                          diff_model_tag &&diff_model) {
+  using edge_mask = Bitmask<int>;
+  using chunk_iterator = typename std::vector<edge_mask>::iterator;
+  std::vector<CompressedEdgeMask> samples(CFG.samples);
+  auto start = std::chrono::high_resolution_clock::now();
+
+  const bool vectorized =
+      CFG.vectorized_sampling &&
+      std::is_same<typename std::decay<diff_model_tag>::type,
+                   independent_cascade_tag>::value;
+  const size_t chunk_size = std::min<size_t>(
+      CFG.samples, 64 * std::max<size_t>(omp_get_max_threads(), 1));
+  std::vector<edge_mask> chunk(chunk_size, edge_mask(G.num_edges()));
+
+  // The engine workers keep their generators across the chunks.
+  using engine_type =
+      SamplingEngine<GraphTy, chunk_iterator, GeneratorTy, diff_model_tag>;
+  std::unique_ptr<VectorizedICSampler<GraphTy>> sampler;
+  std::unique_ptr<engine_type> SE;
+  uint64_t key = 0;
+  if (vectorized) {
+    sampler.reset(new VectorizedICSampler<GraphTy>(G));
+    key = gen();
+  } else {
+    SE.reset(new engine_type(G, gen, CFG.streaming_workers,
+                             CFG.streaming_gpu_workers));
+  }
+
+  for (size_t first = 0; first < samples.size(); first += chunk_size) {
+    const size_t length = std::min(chunk_size, samples.size() - first);
+    auto last = chunk.begin() + length;
+    if (vectorized) {
+      VectorizedSample(*sampler, key, first, chunk.begin(), last);
+    } else {
+      for (auto itr = chunk.begin(); itr != last; ++itr) itr->clear();
+      SE->exec(chunk.begin(), last, record.SamplingTasks);
+    }
+
+#pragma omp parallel for
+    for (size_t i = 0; i < length; ++i)
+      samples[first + i] = CompressedEdgeMask(chunk[i]);
+  }
+
+  auto end = std::chrono::high_resolution_clock::now();
+  record.Sampling = end - start;
+  record.SampleBytes = 0;
+  for (auto &M : samples) record.SampleBytes += M.bytes();
+  return samples;
+}
+
+//! \brief Build implicit samples, only defined by their keys.
+template <typename GraphTy, typename ConfTy>
+auto ImplicitSampleFrom(const ImplicitSampleSpace<GraphTy> &space,
+                        ConfTy &CFG, HillClimbingExecutionRecord &record) {
+  auto start = std::chrono::high_resolution_clock::now();
+  auto samples = space.samples(CFG.samples);
+  auto end = std::chrono::high_resolution_clock::now();
+  record.Sampling = end - start;
   return samples;
 }
 
+//! \brief Approximate seed selection with reachability sketches.
+template <typename GraphTy, typename GraphMaskItrTy, typename ConfigTy>
+auto SketchSeedSelection(GraphTy &G, GraphMaskItrTy B, GraphMaskItrTy E,
+                         ConfigTy &CFG, HillClimbingExecutionRecord &record,
+                         uint64_t key) {
+  SketchSeedSelectionEngine<GraphTy, GraphMaskItrTy> sketchEngine(
+      G, CFG.sketch_size, key);
+  auto start = std::chrono::high_resolution_clock::now();
+  auto S = sketchEngine.exec(B, E, CFG.k, record.SeedSelectionTasks);
+  auto end = std::chrono::high_resolution_clock::now();
+  record.SeedSelection = end - start;
+  record.EstimatedGains = sketchEngine.estimated_gains();
+
+  return S;
+}
+
 template <typename GraphTy, typename GraphMaskItrTy, typename ConfigTy>
 auto SeedSelection(GraphTy &G, GraphMaskItrTy B, GraphMaskItrTy E,
-                   ConfigTy &CFG, HillClimbingExecutionRecord &record) {
+                   ConfigTy &CFG, HillClimbingExecutionRecord &record,
+                   uint64_t sketch_key = 0) {
+  if (CFG.sketch_selection)
+    return SketchSeedSelection(G, B, E, CFG, record, sketch_key);
+
   SeedSelectionEngine<GraphTy, GraphMaskItrTy> countingEngine(
-      G, CFG.streaming_workers, CFG.streaming_gpu_workers);
+      G, CFG.streaming_workers, CFG.streaming_gpu_workers,
+      CFG.counting_options());
   auto start = std::chrono::high_resolution_clock::now();
   auto S = countingEngine.exec(B, E, CFG.k, record.SeedSelectionTasks);
   auto end = std::chrono::high_resolution_clock::now();
   record.SeedSelection = end - start;
+  record.CandidatesPerStep = countingEngine.candidates_per_step();
+  record.SampleBytes += countingEngine.frontier_cache_bytes();
 
   return S;
 }
@@ -147,11 +362,27 @@ template <typename GraphTy, typename GeneratorTy, typename diff_model_tag,
 auto HillClimbing(GraphTy &G, ConfTy &CFG, GeneratorTy &gen,
                   HillClimbingExecutionRecord &record,
                   diff_model_tag &&model_tag) {
+  const uint64_t sketch_key = CFG.sketch_selection ? gen() : 0;
+  if (CFG.implicit_samples) {
+    // The space holds the LT prefix sums: it must outlive the selection.
+    ImplicitSampleSpace<GraphTy> space(G, gen(), model_tag);
+    auto sampled_graphs = ImplicitSampleFrom(space, CFG, record);
+    return SeedSelection(G, sampled_graphs.begin(), sampled_graphs.end(), CFG,
+                         record, sketch_key);
+  }
+
+  if (CFG.compressed_samples) {
+    auto sampled_graphs = CompressedSampleFrom(
+        G, CFG, gen, record, std::forward<diff_model_tag>(model_tag));
+    return SeedSelection(G, sampled_graphs.begin(), sampled_graphs.end(), CFG,
+                         record, sketch_key);
+  }
+
   auto sampled_graphs =
       SampleFrom(G, CFG, gen, record, std::forward<diff_model_tag>(model_tag));
 
   auto S = SeedSelection(G, sampled_graphs.begin(), sampled_graphs.end(), CFG,
-                         record);
+                         record, sketch_key);
 
   return S;
 }
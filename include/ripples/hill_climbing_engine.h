@@ -45,8 +45,13 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "omp.h"
@@ -56,6 +61,10 @@
 #include "trng/uniform01_dist.hpp"
 
 #include "ripples/bitmask.h"
+#include "ripples/compressed_edge_mask.h"
+#include "ripples/diffusion_simulation.h"
+#include "ripples/lazy_greedy_queue.h"
+#include "ripples/live_edge_condensation.h"
 #ifdef RIPPLES_ENABLE_CUDA
 #include "ripples/cuda/cuda_generate_rrr_sets.h"
 #include "ripples/cuda/cuda_graph.cuh"
@@ -223,9 +232,12 @@ class HCGPUSamplingWorker : public HCWorker<GraphTy, ItrTy> {
       assert(false && "Not Yet Implemented");
     }
 
+    // The device packs each sample in (num_edges / 32 + 1) ints, which is
+    // never larger than the host mask.
+    const size_t device_words = G_.num_edges() / (8 * sizeof(int)) + 1;
     for (size_t i = 0; B < E; ++B, ++i) {
-      cuda_d2h(B->data(), d_flags_ + i * (B->bytes() / sizeof(int)),
-               B->bytes(), cuda_stream_);
+      cuda_d2h(B->data(), d_flags_ + i * device_words,
+               device_words * sizeof(int), cuda_stream_);
     }
     cuda_sync(cuda_stream_);
   }
@@ -370,53 +382,53 @@ size_t BFS(GraphTy &G, GraphMaskTy &M, Itr b, Itr e, Bitmask<int> &visited) {
 
   std::queue<vertex_type> queue;
   for (; b != e; ++b) {
-    queue.push(*b);
+    if (visited.test_and_set(*b)) queue.push(*b);
   }
 
   while (!queue.empty()) {
     vertex_type u = queue.front();
     queue.pop();
-    visited.set(u);
 
-    size_t edge_number =
-        std::distance(G.neighbors(0).begin(), G.neighbors(u).begin());
-
-    for (auto v : G.neighbors(u)) {
-      if (M.get(edge_number) && !visited.get(v.vertex)) {
-        queue.push(v.vertex);
-      }
-
-      ++edge_number;
-    }
+    auto edges = G.neighbors(0).begin();
+    for_each_live_edge(M, std::distance(edges, G.neighbors(u).begin()),
+                       std::distance(edges, G.neighbors(u).end()),
+                       [&](size_t e) {
+                         vertex_type v = edges[e].vertex;
+                         if (visited.test_and_set(v)) queue.push(v);
+                       });
   }
 
   return visited.popcount();
 }
 
+//! Count the vertices reached from v that are not marked in visited.
+//!
+//! The traversal marks into visited and records the newly marked vertices in
+//! touched, which also serves as the queue.  They are unmarked before
+//! returning, so that visited is left as it was without being copied.
 template <typename GraphTy, typename GraphMaskTy>
 size_t BFS(GraphTy &G, GraphMaskTy &M, typename GraphTy::vertex_type v,
-           Bitmask<int> visited) {
+           Bitmask<int> &visited,
+           std::vector<typename GraphTy::vertex_type> &touched) {
   using vertex_type = typename GraphTy::vertex_type;
 
-  std::queue<vertex_type> queue;
-
-  queue.push(v);
+  touched.clear();
+  touched.push_back(v);
   visited.set(v);
-  while (!queue.empty()) {
-    vertex_type u = queue.front();
-    queue.pop();
-
-    size_t edge_number =
-        std::distance(G.neighbors(0).begin(), G.neighbors(u).begin());
-    for (auto v : G.neighbors(u)) {
-      if (M.get(edge_number) && !visited.get(v.vertex)) {
-        queue.push(v.vertex);
-        visited.set(v.vertex);
-      }
-      ++edge_number;
-    }
+  for (size_t head = 0; head < touched.size(); ++head) {
+    vertex_type u = touched[head];
+
+    auto edges = G.neighbors(0).begin();
+    for_each_live_edge(M, std::distance(edges, G.neighbors(u).begin()),
+                       std::distance(edges, G.neighbors(u).end()),
+                       [&](size_t e) {
+                         vertex_type v = edges[e].vertex;
+                         if (visited.test_and_set(v)) touched.push_back(v);
+                       });
   }
-  return visited.popcount();
+
+  for (vertex_type u : touched) visited.unset(u);
+  return touched.size();
 }
 }  // namespace
 
@@ -429,8 +441,18 @@ class HCCPUCountingWorker : public HCWorker<GraphTy, ItrTy> {
   using ex_time_ms = std::chrono::duration<double, std::milli>;
 
   HCCPUCountingWorker(const GraphTy &G, std::vector<size_t> &count,
-                      const std::set<vertex_type> &S)
-      : HCWorker<GraphTy, ItrTy>(G), count_(count), S_(S) {}
+                      size_t &base_count, const std::set<vertex_type> &S,
+                      const std::vector<vertex_type> &candidates,
+                      std::vector<Bitmask<int>> &frontier_cache,
+                      const std::vector<size_t> &base_counters)
+      : HCWorker<GraphTy, ItrTy>(G),
+        count_(count),
+        base_count_(base_count),
+        S_(S),
+        candidates_(candidates),
+        frontier_cache_(frontier_cache),
+        base_counters_(base_counters),
+        visited_(G.num_nodes()) {}
 
   void svc_loop(std::atomic<size_t> &mpmc_head, ItrTy B, ItrTy E,
                 std::vector<ex_time_ms> &record) {
@@ -443,33 +465,205 @@ class HCCPUCountingWorker : public HCWorker<GraphTy, ItrTy> {
 
       if (last > E) last = E;
       auto start = std::chrono::high_resolution_clock::now();
-      batch(first, last);
+      batch(first, last, offset);
       auto end = std::chrono::high_resolution_clock::now();
       record.push_back(end - start);
     }
   }
 
+  //! \brief Vertex-parallel counting of one sample.
+  //!
+  //! Must be called by all the threads of the enclosing parallel region: the
+  //! candidates are shared among them and every worker adds to its private
+  //! counters, which are summed by reduce_local_count().
+  //!
+  //! \param M The sample.
+  //! \param frontier The vertices reached by the seed set in M.
+  //! \param base_count The number of vertices in frontier.
+  template <typename GraphMaskTy>
+  void count_vertices(const GraphMaskTy &M, const Bitmask<int> &frontier,
+                      size_t base_count, std::vector<ex_time_ms> &record) {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (local_count_.size() != G_.num_nodes())
+      local_count_.assign(G_.num_nodes(), 0);
+    visited_ = frontier;
+
+    auto update = [&](vertex_type v) {
+      if (S_.find(v) != S_.end()) return;
+      local_count_[v] += visited_.get(v)
+                             ? base_count + 1
+                             : base_count + BFS(G_, M, v, visited_, touched_);
+    };
+    if (candidates_.empty()) {
+#pragma omp for schedule(dynamic, 64)
+      for (size_t v = 0; v < G_.num_nodes(); ++v) update(v);
+    } else {
+#pragma omp for schedule(dynamic, 8)
+      for (size_t i = 0; i < candidates_.size(); ++i) update(candidates_[i]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    record.push_back(end - start);
+  }
+
+  //! Move the private counter of v to the shared counters.
+  void reduce_local_count(vertex_type v) {
+    if (local_count_.empty()) return;
+    count_[v] += local_count_[v];
+    local_count_[v] = 0;
+  }
+
  private:
-  void batch(ItrTy B, ItrTy E) {
-    for (auto itr = B; itr < E; ++itr) {
-      Bitmask<int> visited(G_.num_nodes());
-      size_t base_count = BFS(G_, *itr, S_.begin(), S_.end(), visited);
+  //! Count the samples [B, E), the first one being sample offset.
+  void batch(ItrTy B, ItrTy E, size_t offset) {
+    for (auto itr = B; itr < E; ++itr, ++offset) {
+      // The sample belongs to this worker for the whole pass: its cached
+      // frontier is traversed in place and restored by every BFS.  Without
+      // a cache, the frontier is rebuilt from the seed set.
+      size_t base_count;
+      if (frontier_cache_.empty()) {
+        visited_.clear();
+        base_count = BFS(G_, *itr, S_.begin(), S_.end(), visited_);
+      } else {
+        base_count = base_counters_[offset];
+      }
+      Bitmask<int> &visited =
+          frontier_cache_.empty() ? visited_ : frontier_cache_[offset];
+#pragma omp atomic
+      base_count_ += base_count;
 
-      for (vertex_type v = 0; v < G_.num_nodes(); ++v) {
-        if (S_.find(v) != S_.end()) continue;
+      auto update = [&](vertex_type v) {
+        if (S_.find(v) != S_.end()) return;
         size_t update_count = base_count + 1;
         if (!visited.get(v)) {
-          update_count = BFS(G_, *itr, v, visited);
+          update_count = base_count + BFS(G_, *itr, v, visited, touched_);
         }
 #pragma omp atomic
         count_[v] += update_count;
+      };
+      if (candidates_.empty()) {
+        for (vertex_type v = 0; v < G_.num_nodes(); ++v) update(v);
+      } else {
+        for (vertex_type v : candidates_) update(v);
       }
     }
   }
 
   static constexpr size_t batch_size_ = 2;
   std::vector<size_t> &count_;
+  size_t &base_count_;
   const std::set<vertex_type> &S_;
+  const std::vector<vertex_type> &candidates_;
+  std::vector<Bitmask<int>> &frontier_cache_;
+  const std::vector<size_t> &base_counters_;
+  Bitmask<int> visited_;
+  std::vector<vertex_type> touched_;
+  std::vector<size_t> local_count_;
+};
+
+//! Options of the counting workers of the seed selection.
+struct HCCountingOptions {
+  //! Count over the SCC condensation of every sample.
+  bool scc_counting{false};
+  //! The number of ranks of the reachability sketches.
+  size_t sketch_size{64};
+  //! The largest condensation whose counts are computed exactly.
+  size_t exact_reachability_limit{4096};
+  //! Re-evaluate only the candidates at the top of a CELF queue.
+  bool lazy{false};
+  //! The number of stale candidates evaluated together by the lazy mode.
+  size_t lazy_batch{8};
+  //! How the CPU workers share a counting pass: "samples", "vertices" of
+  //! one sample at a time, or "auto" to choose from the number of samples.
+  std::string parallelism{"auto"};
+  //! Keep the vertices reached by the seed set in every sample across the
+  //! steps, at the cost of one bit per vertex and sample.
+  bool frontier_cache{true};
+};
+
+//! Counting worker over the SCC condensation of the sampled graphs.
+//!
+//! Every sample is condensed the first time the worker meets it, and the
+//! condensation is kept for the following greedy steps.  Each step then
+//! costs one pass over the DAG instead of one BFS per vertex.
+template <typename GraphTy, typename ItrTy>
+class HCCPUSCCCountingWorker : public HCWorker<GraphTy, ItrTy> {
+  using vertex_type = typename GraphTy::vertex_type;
+  using HCWorker<GraphTy, ItrTy>::G_;
+
+ public:
+  using ex_time_ms = std::chrono::duration<double, std::milli>;
+  using condensation_type = LiveEdgeCondensation<vertex_type>;
+
+  HCCPUSCCCountingWorker(const GraphTy &G, std::vector<size_t> &count,
+                         size_t &base_count, const std::set<vertex_type> &S,
+                         const std::vector<vertex_type> &candidates,
+                         std::vector<condensation_type> &condensations,
+                         const HCCountingOptions &options)
+      : HCWorker<GraphTy, ItrTy>(G),
+        count_(count),
+        base_count_(base_count),
+        S_(S),
+        candidates_(candidates),
+        condensations_(condensations),
+        reachability_(options.sketch_size, options.exact_reachability_limit) {}
+
+  void svc_loop(std::atomic<size_t> &mpmc_head, ItrTy B, ItrTy E,
+                std::vector<ex_time_ms> &record) {
+    size_t offset = 0;
+    while ((offset = mpmc_head.fetch_add(batch_size_)) <
+           size_t(std::distance(B, E))) {
+      auto first = B;
+      std::advance(first, offset);
+      auto last = first;
+      std::advance(last, batch_size_);
+
+      if (last > E) last = E;
+      auto start = std::chrono::high_resolution_clock::now();
+      batch(offset, first, last);
+      auto end = std::chrono::high_resolution_clock::now();
+      record.push_back(end - start);
+    }
+  }
+
+ private:
+  void batch(size_t offset, ItrTy B, ItrTy E) {
+    for (auto itr = B; itr < E; ++itr, ++offset) {
+      condensation_type &C = condensations_[offset];
+      if (C.empty()) C = CondenseLiveEdgeGraph(G_, *itr);
+
+      size_t base_count = reachability_.reach(C, S_.begin(), S_.end());
+      components_.clear();
+      for (vertex_type v : candidates_) components_.push_back(C.component[v]);
+      auto &gains = reachability_.gains(C, world_key(0, offset), components_);
+#pragma omp atomic
+      base_count_ += base_count;
+
+      auto update = [&](vertex_type v) {
+        if (S_.find(v) != S_.end()) return;
+        uint32_t c = C.component[v];
+        // Same convention as HCCPUCountingWorker for reached vertices.
+        size_t update_count = reachability_.reached(c)
+                                  ? base_count + 1
+                                  : base_count + std::llround(gains[c]);
+#pragma omp atomic
+        count_[v] += update_count;
+      };
+      if (candidates_.empty()) {
+        for (vertex_type v = 0; v < G_.num_nodes(); ++v) update(v);
+      } else {
+        for (vertex_type v : candidates_) update(v);
+      }
+    }
+  }
+
+  static constexpr size_t batch_size_ = 2;
+  std::vector<size_t> &count_;
+  size_t &base_count_;
+  const std::set<vertex_type> &S_;
+  const std::vector<vertex_type> &candidates_;
+  std::vector<condensation_type> &condensations_;
+  std::vector<uint32_t> components_;
+  CondensedReachability<vertex_type> reachability_;
 };
 
 template <typename GraphTy, typename ItrTy>
@@ -502,12 +696,15 @@ class HCGPUCountingWorker : public HCWorker<GraphTy, ItrTy> {
 
   HCGPUCountingWorker(const config_t &conf, const GraphTy &G,
                       cuda_ctx<GraphTy> *ctx, std::vector<size_t> &count,
-                      const std::set<vertex_type> &S)
+                      size_t &base_count, const std::set<vertex_type> &S,
+                      const std::vector<vertex_type> &candidates)
       : HCWorker<GraphTy, ItrTy>(G),
         conf_(conf),
         ctx_(ctx),
         count_(count),
+        base_count_(base_count),
         S_(S),
+        candidates_(candidates),
         edge_filter_(new d_vertex_type[G_.num_edges()]) {
     cuda_set_device(ctx_->gpu_id);
     cuda_stream_create(&cuda_stream_);
@@ -559,7 +756,8 @@ class HCGPUCountingWorker : public HCWorker<GraphTy, ItrTy> {
   void batch(ItrTy B, ItrTy E) {
     std::vector<d_vertex_type> seeds(S_.begin(), S_.end());
     for (auto itr = B; itr < E; ++itr) {
-      cuda_h2d(d_edge_filter_, itr->data(), itr->bytes(), cuda_stream_);
+      const Bitmask<int> &mask = host_mask(*itr);
+      cuda_h2d(d_edge_filter_, mask.data(), mask.bytes(), cuda_stream_);
 
       d_vertex_type base_count;
       solver_->traverse(seeds.data(), seeds.size(), visited_.get(),
@@ -568,8 +766,11 @@ class HCGPUCountingWorker : public HCWorker<GraphTy, ItrTy> {
       // cuda_d2h(predecessors_, d_predecessors_,
       // G_.num_nodes() * sizeof(d_vertex_type), cuda_stream_);
       cuda_sync(cuda_stream_);
-      for (vertex_type v = 0; v < G_.num_nodes(); ++v) {
-        if (S_.find(v) != S_.end()) continue;
+#pragma omp atomic
+      base_count_ += base_count;
+
+      auto update = [&](vertex_type v) {
+        if (S_.find(v) != S_.end()) return;
         size_t update_count = base_count + 1;
         int m = 1 << (v % (8 * sizeof(int)));
         if ((visited_[v / (8 * sizeof(int))] && m) == 0) {
@@ -581,11 +782,26 @@ class HCGPUCountingWorker : public HCWorker<GraphTy, ItrTy> {
         }
 #pragma omp atomic
         count_[v] += update_count;
+      };
+      if (candidates_.empty()) {
+        for (vertex_type v = 0; v < G_.num_nodes(); ++v) update(v);
+      } else {
+        for (vertex_type v : candidates_) update(v);
       }
     }
   }
 
+  const Bitmask<int> &host_mask(const Bitmask<int> &M) { return M; }
+
+  //! Implicit samples are materialized before the copy to the device.
+  template <typename MaskTy>
+  const Bitmask<int> &host_mask(const MaskTy &M) {
+    M.materialize(host_mask_);
+    return host_mask_;
+  }
+
   static constexpr size_t batch_size_ = 2;
+  Bitmask<int> host_mask_;
   config_t conf_;
   cuda_ctx<GraphTy> *ctx_;
   cudaStream_t cuda_stream_;
@@ -595,7 +811,9 @@ class HCGPUCountingWorker : public HCWorker<GraphTy, ItrTy> {
   d_vertex_type *d_edge_filter_;
 
   std::vector<size_t> &count_;
+  size_t &base_count_;
   const std::set<vertex_type> &S_;
+  const std::vector<vertex_type> &candidates_;
 #endif
 };
 
@@ -604,15 +822,18 @@ class SeedSelectionEngine {
   using vertex_type = typename GraphTy::vertex_type;
   using worker_type = HCWorker<GraphTy, ItrTy>;
   using cpu_worker_type = HCCPUCountingWorker<GraphTy, ItrTy>;
+  using scc_worker_type = HCCPUSCCCountingWorker<GraphTy, ItrTy>;
   using gpu_worker_type = HCGPUCountingWorker<GraphTy, ItrTy>;
 
  public:
   using ex_time_ms = std::chrono::duration<double, std::milli>;
 
-  SeedSelectionEngine(const GraphTy &G, size_t cpu_workers, size_t gpu_workers)
+  SeedSelectionEngine(const GraphTy &G, size_t cpu_workers, size_t gpu_workers,
+                      const HCCountingOptions &options = HCCountingOptions())
       : G_(G),
         count_(G_.num_nodes()),
         S_(),
+        options_(options),
         logger_(spdlog::stdout_color_mt("SeedSelectionEngine")) {
     size_t num_threads = cpu_workers + gpu_workers;
     // Construct workers.
@@ -626,9 +847,15 @@ class SeedSelectionEngine {
 
 #pragma omp parallel
     {
-      int rank = omp_get_thread_num();
-      if (rank < cpu_workers) {
-        auto w = new cpu_worker_type(G_, count_, S_);
+      size_t rank = omp_get_thread_num();
+      if (rank < cpu_workers && options_.scc_counting) {
+        workers_[rank] =
+            new scc_worker_type(G_, count_, base_count_, S_, candidates_,
+                                condensations_, options_);
+        logger_->debug("> mapping: omp {}\t->CPU (SCC)", rank);
+      } else if (rank < cpu_workers) {
+        auto w = new cpu_worker_type(G_, count_, base_count_, S_, candidates_,
+                                     frontier_cache_, base_counters_);
         workers_[rank] = w;
         cpu_workers_[rank] = w;
         logger_->debug("> mapping: omp {}\t->CPU", rank);
@@ -642,7 +869,7 @@ class SeedSelectionEngine {
         cuda_contexts_[rank - cpu_workers] = cuda_make_ctx(G, device_id);
         typename gpu_worker_type::config_t gpu_conf(gpu_workers);
         auto w = new gpu_worker_type(gpu_conf, G_, cuda_contexts_[rank - cpu_workers],  // changed from .back()
-                                     count_, S_);
+                                     count_, base_count_, S_, candidates_);
         workers_[rank] = w;
         gpu_workers_[rank - cpu_workers] = w;
         logger_->trace("Cuda Context Built!");
@@ -670,33 +897,181 @@ class SeedSelectionEngine {
     record.resize(workers_.size());
     std::vector<vertex_type> result;
     result.reserve(k);
+    // Condensations are built during the first step and kept for the others.
+    if (options_.scc_counting) {
+      condensations_.clear();
+      condensations_.resize(std::distance(B, E));
+    } else if (options_.frontier_cache) {
+      frontier_cache_.assign(std::distance(B, E),
+                             Bitmask<int>(G_.num_nodes()));
+      base_counters_.assign(std::distance(B, E), 0);
+    }
+    candidates_per_step_.clear();
+    LazyGreedyQueue<vertex_type, long long> queue;
     for (size_t i = 0; i < k; ++i) {
-#pragma omp parallel for
-      for (size_t j = 0; j < count_.size(); ++j) count_[j] = 0;
-
-      mpmc_head_.store(0);
-#pragma omp parallel
-      {
-        assert(workers_.size() == omp_get_num_threads());
-        size_t rank = omp_get_thread_num();
-        workers_[rank]->svc_loop(mpmc_head_, B, E, record[rank]);
+      // Every vertex is already a seed when k is larger than the graph.
+      if (options_.lazy && i != 0 && queue.empty()) {
+        logger_->warn("No candidates left after {} seeds", i);
+        break;
+      }
+      vertex_type v;
+      size_t count;
+      if (!options_.lazy || i == 0) {
+        candidates_.clear();
+        count_pass(B, E, record);
+        candidates_per_step_.push_back(G_.num_nodes() - S_.size());
+
+        auto itr = std::max_element(count_.begin(), count_.end());
+        v = std::distance(count_.begin(), itr);
+        count = *itr;
+        if (options_.lazy) {
+          for (vertex_type u = 0; u < G_.num_nodes(); ++u)
+            if (u != v) queue.push(u, count_[u], i);
+        }
+      } else {
+        // Stale gains are upper bounds: evaluate the top until it is fresh.
+        // The batch doubles at every pass, so that a step needs a
+        // logarithmic number of passes even when most gains collapse.
+        size_t evaluated = 0;
+        for (size_t batch = options_.lazy_batch; !queue.fresh(i); batch *= 2) {
+          candidates_ = queue.pop_stale(batch, i);
+          count_pass(B, E, record);
+          for (vertex_type u : candidates_)
+            queue.push(u, (long long)count_[u] - base_count_, i);
+          evaluated += candidates_.size();
+        }
+        candidates_per_step_.push_back(evaluated);
+        v = queue.pop().first;
+        count = count_[v];
       }
-
-      auto itr = std::max_element(count_.begin(), count_.end());
-      vertex_type v = std::distance(count_.begin(), itr);
       S_.insert(v);
       result.push_back(v);
-      logger_->trace("Seed {} : {}[{}] = {}", i, v, G_.convertID(v), *itr);
+      if (!frontier_cache_.empty() && i + 1 < k) extend_frontiers(B, v);
+      logger_->trace("Seed {} : {}[{}] = {}", i, v, G_.convertID(v), count);
     }
 
     logger_->trace("End Seed Selection");
     return result;
   }
 
+  //! The number of candidates evaluated at every step.
+  const std::vector<size_t> &candidates_per_step() const {
+    return candidates_per_step_;
+  }
+
+  //! The memory held by the cached frontiers in bytes.
+  size_t frontier_cache_bytes() const {
+    size_t bytes = base_counters_.size() * sizeof(size_t);
+    for (auto &frontier : frontier_cache_) bytes += frontier.bytes();
+    return bytes;
+  }
+
  private:
+  //! Count over all the samples, for the candidates or all the vertices.
+  void count_pass(ItrTy B, ItrTy E,
+                  std::vector<std::vector<ex_time_ms>> &record) {
+    if (candidates_.empty()) {
+#pragma omp parallel for
+      for (size_t j = 0; j < count_.size(); ++j) count_[j] = 0;
+    } else {
+      for (vertex_type v : candidates_) count_[v] = 0;
+    }
+    base_count_ = 0;
+
+    if (vertex_parallel(std::distance(B, E))) {
+      vertex_parallel_pass(B, E, record);
+      return;
+    }
+
+    mpmc_head_.store(0);
+#pragma omp parallel
+    {
+      assert(workers_.size() == omp_get_num_threads());
+      size_t rank = omp_get_thread_num();
+      workers_[rank]->svc_loop(mpmc_head_, B, E, record[rank]);
+    }
+  }
+
+  //! \brief Whether a pass over num_samples samples splits the vertices.
+  //!
+  //! Only plain CPU workers can share a sample.  With fewer than
+  //! two batches of samples per worker, the sample-parallel pass leaves
+  //! workers idle for most of its duration.
+  bool vertex_parallel(size_t num_samples) const {
+    if (options_.scc_counting || cpu_workers_.size() != workers_.size())
+      return false;
+    if (options_.parallelism == "vertices") return true;
+    if (options_.parallelism == "samples") return false;
+    return num_samples < 4 * workers_.size();
+  }
+
+  //! \brief Extend the cached frontier of every sample with the vertices
+  //! reached from the new seed v.
+  void extend_frontiers(ItrTy B, vertex_type v) {
+#pragma omp parallel for schedule(dynamic)
+    for (size_t s = 0; s < frontier_cache_.size(); ++s) {
+      if (!frontier_cache_[s].get(v))
+        base_counters_[s] = BFS(G_, B[s], &v, &v + 1, frontier_cache_[s]);
+    }
+  }
+
+  //! \brief Count the samples one at a time, splitting their vertices.
+  void vertex_parallel_pass(ItrTy B, ItrTy E,
+                            std::vector<std::vector<ex_time_ms>> &record) {
+    const bool cached = !frontier_cache_.empty();
+    if (cached)
+      base_count_ = std::accumulate(base_counters_.begin(),
+                                    base_counters_.end(), size_t(0));
+    else if (frontier_.size() != G_.num_nodes())
+      frontier_ = Bitmask<int>(G_.num_nodes());
+    size_t sample_base_count = 0;
+
+#pragma omp parallel
+    {
+      assert(workers_.size() == size_t(omp_get_num_threads()));
+      size_t rank = omp_get_thread_num();
+      // count_vertices ends with a barrier between two samples.
+      for (size_t s = 0; s < size_t(std::distance(B, E)); ++s) {
+        if (cached) {
+          cpu_workers_[rank]->count_vertices(B[s], frontier_cache_[s],
+                                             base_counters_[s], record[rank]);
+          continue;
+        }
+#pragma omp single
+        {
+          frontier_.clear();
+          sample_base_count = BFS(G_, B[s], S_.begin(), S_.end(), frontier_);
+          base_count_ += sample_base_count;
+        }
+        cpu_workers_[rank]->count_vertices(B[s], frontier_, sample_base_count,
+                                           record[rank]);
+      }
+
+      if (candidates_.empty()) {
+#pragma omp for
+        for (size_t v = 0; v < G_.num_nodes(); ++v)
+          for (auto w : cpu_workers_) w->reduce_local_count(v);
+      } else {
+#pragma omp for
+        for (size_t i = 0; i < candidates_.size(); ++i)
+          for (auto w : cpu_workers_) w->reduce_local_count(candidates_[i]);
+      }
+    }
+  }
+
   const GraphTy &G_;
   std::vector<size_t> count_;
+  size_t base_count_{0};
+  //! The vertices reached by the seed set in every sample, and their number.
+  std::vector<Bitmask<int>> frontier_cache_;
+  std::vector<size_t> base_counters_;
+  //! The frontier of the current sample when frontiers are not cached.
+  Bitmask<int> frontier_;
+  std::vector<vertex_type> candidates_;
+  std::vector<size_t> candidates_per_step_;
   std::set<vertex_type> S_;
+  HCCountingOptions options_;
+  std::vector<typename scc_worker_type::condensation_type> condensations_;
   // size_t gpu_workers_;
   // size_t cpu_workers_;
 
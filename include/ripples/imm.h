@@ -43,9 +43,12 @@
 #ifndef RIPPLES_IMM_H
 #define RIPPLES_IMM_H
 
+#include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <limits>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -58,6 +61,9 @@
 #include "ripples/find_most_influential.h"
 #include "ripples/generate_rrr_sets.h"
 #include "ripples/imm_execution_record.h"
+#include "ripples/incremental_find_most_influential.h"
+#include "ripples/rrr_sample_store.h"
+#include "ripples/rrr_spill_store.h"
 #include "ripples/tim.h"
 #include "ripples/utility.h"
 
@@ -75,6 +81,17 @@ struct IMMConfiguration : public TIMConfiguration {
   size_t seed_select_max_gpu_workers{0};
   std::string gpu_mapping_string{""};
   std::unordered_map<size_t, size_t> worker_to_gpu;
+  bool deterministic_sampling{false};
+  size_t numa_domains{1};
+  bool numa_graph_replicas{false};
+  bool fused_counting{false};
+  bool incremental_selection{false};
+  size_t memory_budget{0};
+  std::string spill_directory{"/tmp"};
+  std::string save_rrr_sets{""};
+  std::string load_rrr_sets{""};
+  uint64_t rng_seed{0};
+  std::vector<size_t> seed_set_sizes;
 
   //! \brief Add command line options to configure IMM.
   //!
@@ -94,6 +111,43 @@ struct IMMConfiguration : public TIMConfiguration {
     app.add_option("--seed-select-max-gpu-workers", seed_select_max_gpu_workers,
                    "The max number of GPU workers for seed selection.")
         ->group("Streaming-Engine Options");
+    app.add_flag("--deterministic-sampling", deterministic_sampling,
+                 "Sample RRR sets independently of the number of workers.")
+        ->group("Streaming-Engine Options");
+    app.add_option("--numa-domains", numa_domains,
+                   "The number of NUMA domains the workers are spread over.")
+        ->group("Streaming-Engine Options");
+    app.add_flag("--numa-graph-replicas", numa_graph_replicas,
+                 "Replicate the input graph on every NUMA domain.")
+        ->group("Streaming-Engine Options");
+    app.add_flag("--fused-counting", fused_counting,
+                 "Count vertex occurrencies while generating RRR sets.")
+        ->group("Streaming-Engine Options");
+    app.add_flag("--incremental-selection", incremental_selection,
+                 "Reuse the seed selection state across theta estimation "
+                 "rounds.")
+        ->group("Streaming-Engine Options");
+    app.add_option("--memory-budget", memory_budget,
+                   "The memory (MiB) for RRR sets before spilling them to "
+                   "disk (0 disables spilling).")
+        ->group("Streaming-Engine Options");
+    app.add_option("--spill-directory", spill_directory,
+                   "The directory where RRR sets are spilled.")
+        ->group("Streaming-Engine Options");
+    app.add_option("--save-rrr-sets", save_rrr_sets,
+                   "Save the RRR sets to a file for later runs.")
+        ->group("Streaming-Engine Options");
+    app.add_option("--load-rrr-sets", load_rrr_sets,
+                   "Start from the RRR sets saved in a file by a previous run.")
+        ->group("Streaming-Engine Options");
+    app.add_option("--rng-seed", rng_seed,
+                   "The seed of the random number generator.")
+        ->group("Streaming-Engine Options");
+    app.add_option("--seed-set-sizes", seed_set_sizes,
+                   "A comma-separated list of seed set sizes selected in a "
+                   "single run (the largest overrides -k).")
+        ->delimiter(',')
+        ->group("Algorithm Options");
   }
 };
 
@@ -170,7 +224,10 @@ template <typename GraphTy, typename ConfTy, typename RRRGeneratorTy,
           typename diff_model_tag, typename execution_tag>
 auto Sampling(const GraphTy &G, const ConfTy &CFG, double l,
               RRRGeneratorTy &generator, IMMExecutionRecord &record,
-              diff_model_tag &&model_tag, execution_tag &&ex_tag) {
+              diff_model_tag &&model_tag, execution_tag &&ex_tag,
+              IncrementalFindMostInfluential<GraphTy> *selector = nullptr,
+              RRRSpillStore<GraphTy> *spill = nullptr,
+              RRRsets<GraphTy> &&initial = RRRsets<GraphTy>()) {
   using vertex_type = typename GraphTy::vertex_type;
   size_t k = CFG.k;
   double epsilon = CFG.epsilon;
@@ -186,7 +243,29 @@ auto Sampling(const GraphTy &G, const ConfTy &CFG, double l,
   #else
   RRRsetAllocator<vertex_type> allocator;
   #endif
-  std::vector<RRRset<GraphTy>> RR;
+  // RRR sets loaded from a previous run are reused before generating more.
+  std::vector<RRRset<GraphTy>> RR(std::move(initial));
+
+  // With a spill store, RR holds only the RRR sets still in memory.
+  auto num_sets = [&]() -> size_t {
+    return RR.size() + (spill != nullptr ? spill->num_sets() : 0);
+  };
+  auto generate = [&](size_t delta) {
+    while (delta != 0) {
+      size_t step =
+          spill != nullptr ? std::min(delta, spill->batch_size(RR)) : delta;
+      RR.insert(RR.end(), step, RRRset<GraphTy>(allocator));
+
+      auto begin = RR.end() - step;
+
+      GenerateRRRSets(G, generator, begin, RR.end(), record,
+                      std::forward<diff_model_tag>(model_tag),
+                      std::forward<execution_tag>(ex_tag));
+      delta -= step;
+
+      if (spill != nullptr && spill->over_budget(RR)) spill->spill(RR);
+    }
+  };
 
   auto start = std::chrono::high_resolution_clock::now();
   size_t thetaPrime = 0;
@@ -195,26 +274,29 @@ auto Sampling(const GraphTy &G, const ConfTy &CFG, double l,
     ssize_t thetaPrime = ThetaPrime(x, epsilonPrime, l, k, G.num_nodes(),
                                     std::forward<execution_tag>(ex_tag));
 
-    size_t delta = thetaPrime - RR.size();
+    assert(thetaPrime >= 0);
+    size_t target = thetaPrime;
+    size_t delta = target > num_sets() ? target - num_sets() : 0;
     record.ThetaPrimeDeltas.push_back(delta);
 
-    auto timeRRRSets = measure<>::exec_time([&]() {
-      RR.insert(RR.end(), delta, RRRset<GraphTy>(allocator));
-
-      auto begin = RR.end() - delta;
-
-      GenerateRRRSets(G, generator, begin, RR.end(), record,
-                      std::forward<diff_model_tag>(model_tag),
-                      std::forward<execution_tag>(ex_tag));
-    });
+    auto timeRRRSets = measure<>::exec_time([&]() { generate(delta); });
     record.ThetaEstimationGenerateRRR.push_back(timeRRRSets);
 
     double f;
 
     auto timeMostInfluential = measure<>::exec_time([&]() {
+      if (spill != nullptr) {
+        f = spill->find_most_influential_set(RR, k).first;
+        return;
+      }
+      if (selector != nullptr) {
+        f = selector->find_most_influential_set(RR, k).first;
+        return;
+      }
       const auto &S =
           FindMostInfluentialSet(G, CFG, RR, record, generator.isGpuEnabled(),
-                                 std::forward<execution_tag>(ex_tag));
+                                 std::forward<execution_tag>(ex_tag),
+                                 generator.coverage());
 
       f = S.first;
     });
@@ -237,16 +319,7 @@ auto Sampling(const GraphTy &G, const ConfTy &CFG, double l,
   spdlog::get("console")->info("Theta {}", theta);
 
   record.GenerateRRRSets = measure<>::exec_time([&]() {
-    if (theta > RR.size()) {
-      size_t final_delta = theta - RR.size();
-      RR.insert(RR.end(), final_delta, RRRset<GraphTy>(allocator));
-
-      auto begin = RR.end() - final_delta;
-
-      GenerateRRRSets(G, generator, begin, RR.end(), record,
-                      std::forward<diff_model_tag>(model_tag),
-                      std::forward<execution_tag>(ex_tag));
-    }
+    if (theta > num_sets()) generate(theta - num_sets());
   });
 
   return RR;
@@ -407,9 +480,68 @@ auto IMM(const GraphTy &G, const ConfTy &CFG, double l, GeneratorTy &gen,
 
   l = l * (1 + 1 / std::log2(G.num_nodes()));
 
+  size_t num_threads(1);
+#pragma omp single
+  num_threads =
+      std::min<size_t>(omp_get_max_threads(), CFG.seed_select_max_workers);
+
+  std::unique_ptr<RRRSpillStore<GraphTy>> spill;
+  std::unique_ptr<IncrementalFindMostInfluential<GraphTy>> selector;
+  if (CFG.memory_budget != 0)
+    spill.reset(new RRRSpillStore<GraphTy>(
+        G, CFG.spill_directory, CFG.memory_budget << 20, num_threads));
+  else if (CFG.incremental_selection)
+    selector.reset(new IncrementalFindMostInfluential<GraphTy>(G, num_threads));
+
+  // Loaded RRR sets take the first positions of the global sequence, so the
+  // generator continues from there.
+  RRRsets<GraphTy> loaded;
+  if (!CFG.load_rrr_sets.empty()) {
+    loaded = LoadRRRSets(CFG.load_rrr_sets, G, diffusion_model_name(model_tag),
+                         CFG.rng_seed);
+    gen.skip(loaded.size());
+    spdlog::get("console")->info("Loaded {} RRR sets from {}", loaded.size(),
+                                 CFG.load_rrr_sets);
+  }
+
   auto R =
       Sampling(G, CFG, l, gen, record, std::forward<diff_model_tag>(model_tag),
-               std::forward<omp_parallel_tag>(ex_tag));
+               std::forward<omp_parallel_tag>(ex_tag), selector.get(),
+               spill.get(), std::move(loaded));
+
+  // Greedy selection for the largest k yields the seed sets of all the smaller
+  // sizes as prefixes.  Every size still needs enough RRR sets for its own
+  // approximation bound: a smaller k has a smaller lower bound on OPT and may
+  // need more samples.
+  if (!CFG.seed_set_sizes.empty()) {
+    ConfTy CFGk(CFG);
+    auto theta_estimation = record.ThetaEstimationTotal;
+    auto generate_rrr_sets = record.GenerateRRRSets;
+    const size_t theta_k = record.Theta;
+    size_t theta = theta_k;
+    for (size_t size : CFG.seed_set_sizes) {
+      if (size == k) {
+        record.SeedSetSizesTheta.push_back(theta_k);
+        continue;
+      }
+      CFGk.k = size;
+      R = Sampling(G, CFGk, l, gen, record,
+                   std::forward<diff_model_tag>(model_tag),
+                   std::forward<omp_parallel_tag>(ex_tag), selector.get(),
+                   spill.get(), std::move(R));
+      record.SeedSetSizesTheta.push_back(record.Theta);
+      theta = std::max(theta, record.Theta);
+      theta_estimation += record.ThetaEstimationTotal;
+      generate_rrr_sets += record.GenerateRRRSets;
+    }
+    record.Theta = theta;
+    record.ThetaEstimationTotal = theta_estimation;
+    record.GenerateRRRSets = generate_rrr_sets;
+  }
+
+  if (!CFG.save_rrr_sets.empty())
+    SaveRRRSets(CFG.save_rrr_sets, G, diffusion_model_name(model_tag),
+                CFG.rng_seed, R);
 
 #if CUDA_PROFILE
   auto logst = spdlog::stdout_color_st("IMM-profile");
@@ -425,18 +557,27 @@ auto IMM(const GraphTy &G, const ConfTy &CFG, double l, GeneratorTy &gen,
 
   auto start = std::chrono::high_resolution_clock::now();
   const auto &S =
-      FindMostInfluentialSet(G, CFG, R, record, gen.isGpuEnabled(),
-                             std::forward<omp_parallel_tag>(ex_tag));
+      spill ? spill->find_most_influential_set(R, k)
+      : selector
+          ? selector->find_most_influential_set(R, k)
+          : FindMostInfluentialSet(G, CFG, R, record, gen.isGpuEnabled(),
+                                   std::forward<omp_parallel_tag>(ex_tag),
+                                   gen.coverage());
   auto end = std::chrono::high_resolution_clock::now();
 
   record.FindMostInfluentialSet = end - start;
 
+  if (!CFG.seed_set_sizes.empty())
+    record.PrefixCoverage = spill ? spill->prefix_coverage(R, S.second)
+                                  : PrefixCoverage(G, R, S.second, num_threads);
+
   start = std::chrono::high_resolution_clock::now();
   size_t total_size = 0;
 #pragma omp parallel for reduction(+:total_size)
   for (size_t i = 0; i < R.size(); ++i) {
     total_size += R[i].size() * sizeof(vertex_type);
   }
+  if (spill) total_size += spill->spilled_bytes();
   record.RRRSetSize = total_size;
   end = std::chrono::high_resolution_clock::now();
   record.Total = end - start;
@@ -94,6 +94,12 @@ struct IMMExecutionRecord {
   size_t RRRSetSize{0};
   //! Iterations breakdown
   std::vector<walk_iteration_prof> WalkIterations;
+  //! Per generation round, the time each walk worker waited for the others.
+  std::vector<std::vector<ex_time_ms>> WalkWorkersIdle;
+  //! Number of RRR sets required by each of the requested seed set sizes.
+  std::vector<size_t> SeedSetSizesTheta;
+  //! Fraction of RRR sets covered by every prefix of the seed set.
+  std::vector<double> PrefixCoverage;
 };
 
 }  // namespace ripples
@@ -0,0 +1,169 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_IMPLICIT_EDGE_MASK_H
+#define RIPPLES_IMPLICIT_EDGE_MASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ripples/bitmask.h"
+#include "ripples/counter_rng.h"
+#include "ripples/diffusion_simulation.h"
+
+namespace ripples {
+
+template <typename GraphTy>
+class ImplicitEdgeMask;
+
+//! \brief The shared state of the implicit live-edge samples of a graph.
+//!
+//! A sample is only a key: the liveness of an edge is recomputed from the
+//! key with a counter-based generator every time it is queried, with the
+//! same rules as HCCPUSamplingWorker.  Under IC the counter is the edge
+//! number; under LT it is the source vertex, whose threshold is compared
+//! with the prefix sums of its out-edge weights, precomputed here once for
+//! all the samples.
+//!
+//! \tparam GraphTy The type of the input graph.
+template <typename GraphTy>
+class ImplicitSampleSpace {
+  using vertex_type = typename GraphTy::vertex_type;
+  using edge_weight_type = typename GraphTy::edge_type::edge_weight;
+
+ public:
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  //! \param key The seed of the samples.
+  //! \param model_tag The diffusion model.
+  ImplicitSampleSpace(const GraphTy &G, uint64_t key,
+                      const independent_cascade_tag &)
+      : G_(G), key_(key), linear_threshold_(false) {}
+
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  //! \param key The seed of the samples.
+  //! \param model_tag The diffusion model.
+  ImplicitSampleSpace(const GraphTy &G, uint64_t key,
+                      const linear_threshold_tag &)
+      : G_(G),
+        key_(key),
+        linear_threshold_(true),
+        source_(G.num_edges()),
+        prefix_(G.num_edges()) {
+    size_t edge_number = 0;
+    for (vertex_type v = 0; v < G.num_nodes(); ++v) {
+      edge_weight_type prefix = 0;
+      for (auto &e : G.neighbors(v)) {
+        prefix += e.weight;
+        source_[edge_number] = v;
+        prefix_[edge_number] = prefix;
+        ++edge_number;
+      }
+    }
+  }
+
+  //! \brief The masks of the first num_samples samples.
+  std::vector<ImplicitEdgeMask<GraphTy>> samples(size_t num_samples) const {
+    std::vector<ImplicitEdgeMask<GraphTy>> result;
+    result.reserve(num_samples);
+    for (size_t i = 0; i < num_samples; ++i)
+      result.emplace_back(*this, world_key(key_, i));
+    return result;
+  }
+
+  //! \brief Whether an edge is live in the sample with the given key.
+  bool live(uint64_t key, size_t edge_number) const {
+    if (linear_threshold_)
+      return counter_uniform(key, source_[edge_number]) <=
+             prefix_[edge_number];
+    return counter_uniform(key, edge_number) <=
+           G_.csr_edges()[edge_number].weight;
+  }
+
+  //! \brief The number of edges of the graph.
+  size_t num_edges() const { return G_.num_edges(); }
+
+ private:
+  const GraphTy &G_;
+  uint64_t key_;
+  bool linear_threshold_;
+  std::vector<vertex_type> source_;
+  std::vector<edge_weight_type> prefix_;
+};
+
+//! \brief A live-edge sample stored as its key.
+//!
+//! Drop-in replacement of Bitmask<int> for the read-only uses of the hill
+//! climbing counting phase.
+//!
+//! \tparam GraphTy The type of the input graph.
+template <typename GraphTy>
+class ImplicitEdgeMask {
+ public:
+  ImplicitEdgeMask(const ImplicitSampleSpace<GraphTy> &space, uint64_t key)
+      : space_(&space), key_(key) {}
+
+  bool get(size_t i) const { return space_->live(key_, i); }
+
+  size_t size() const { return space_->num_edges(); }
+
+  //! \brief Store the sample in a bitmask, e.g., to copy it to a device.
+  void materialize(Bitmask<int> &M) const {
+    if (M.size() != size()) M = Bitmask<int>(size());
+    M.clear();
+    for (size_t i = 0; i < size(); ++i)
+      if (get(i)) M.set(i);
+  }
+
+ private:
+  const ImplicitSampleSpace<GraphTy> *space_;
+  uint64_t key_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_IMPLICIT_EDGE_MASK_H
@@ -0,0 +1,204 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_INCREMENTAL_FIND_MOST_INFLUENTIAL_H
+#define RIPPLES_INCREMENTAL_FIND_MOST_INFLUENTIAL_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <omp.h>
+
+#include "ripples/generate_rrr_sets.h"
+
+namespace ripples {
+
+//! \brief Seed selection over a collection of RRR sets that only grows.
+//!
+//! The object keeps the occurrence counters and an inverted index (vertex to
+//! the RRR sets containing it) across the rounds of the theta estimation.
+//! New RRR sets are absorbed as they are appended to the collection and every
+//! greedy pass starts from a copy of the counters, touching only the RRR sets
+//! that get covered.  Unlike FindMostInfluentialSet, the collection is never
+//! reordered: RRR sets are identified by their position.
+//!
+//! \tparam GraphTy The type of the input graph.
+template <typename GraphTy>
+class IncrementalFindMostInfluential {
+  using vertex_type = typename GraphTy::vertex_type;
+  using set_id_type = uint32_t;
+
+ public:
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  //! \param num_threads The number of threads to use.
+  IncrementalFindMostInfluential(const GraphTy &G, size_t num_threads)
+      : num_threads_(num_threads),
+        counters_(G.num_nodes(), 0),
+        index_(G.num_nodes()) {}
+
+  //! The number of RRR sets absorbed so far.
+  size_t num_sets() const { return num_sets_; }
+
+  //! \brief Absorb the RRR sets appended since the last call.
+  //!
+  //! Each thread owns a range of vertices, so that counters and index lists
+  //! are updated without synchronization.
+  //!
+  //! \param RR The collection of RRR sets, grown only by appending.
+  void absorb(const RRRsets<GraphTy> &RR) {
+    assert(RR.size() >= num_sets_);
+    assert(RR.size() <= std::numeric_limits<set_id_type>::max());
+    auto begin = RR.begin() + num_sets_;
+    auto end = RR.end();
+    size_t first_id = num_sets_;
+    num_sets_ = RR.size();
+
+#pragma omp parallel num_threads(num_threads_)
+    {
+      size_t num_elements = counters_.size();
+      size_t threadnum = omp_get_thread_num(),
+             numthreads = omp_get_num_threads();
+      vertex_type low = num_elements * threadnum / numthreads,
+                  high = num_elements * (threadnum + 1) / numthreads;
+
+      set_id_type id = first_id;
+      for (auto itr = begin; itr != end; ++itr, ++id) {
+        auto first = std::lower_bound(itr->begin(), itr->end(), low);
+        auto last = std::upper_bound(first, itr->end(), high - 1);
+        for (; first != last; ++first) {
+          counters_[*first] += 1;
+          index_[*first].push_back(id);
+        }
+      }
+    }
+  }
+
+  //! \brief Select k seeds greedily over all the RRR sets.
+  //!
+  //! RRR sets appended since the previous call are absorbed first.
+  //!
+  //! \param RR The collection of RRR sets, grown only by appending.
+  //! \param k The size of the seed set.
+  //!
+  //! \return a pair where the double is the fraction of RRR sets covered and
+  //! the vector the seeds selected.
+  std::pair<double, std::vector<vertex_type>> find_most_influential_set(
+      const RRRsets<GraphTy> &RR, size_t k) {
+    absorb(RR);
+
+    std::vector<uint32_t> coverage(counters_);
+    std::vector<uint8_t> covered(num_sets_, 0);
+
+    auto cmp = [](const std::pair<vertex_type, uint32_t> &a,
+                  const std::pair<vertex_type, uint32_t> &b) {
+      return a.second < b.second;
+    };
+    std::vector<std::pair<vertex_type, uint32_t>> queue_storage(
+        coverage.size());
+#pragma omp parallel for num_threads(num_threads_)
+    for (size_t v = 0; v < coverage.size(); ++v)
+      queue_storage[v] = {vertex_type(v), coverage[v]};
+
+    std::priority_queue<std::pair<vertex_type, uint32_t>,
+                        std::vector<std::pair<vertex_type, uint32_t>>,
+                        decltype(cmp)>
+        queue(cmp, std::move(queue_storage));
+
+    std::vector<vertex_type> result;
+    result.reserve(k);
+    size_t uncovered = num_sets_;
+
+    while (result.size() < k && uncovered != 0 && !queue.empty()) {
+      auto element = queue.top();
+      queue.pop();
+
+      if (element.second > coverage[element.first]) {
+        element.second = coverage[element.first];
+        queue.push(element);
+        continue;
+      }
+
+      result.push_back(element.first);
+
+      // Walk the sets newly covered by the seed and discount their vertices.
+      // The ids in a list are distinct, so the covered flags are not shared.
+      const auto &sets = index_[element.first];
+      size_t newly_covered = 0;
+#pragma omp parallel for reduction(+ : newly_covered) \
+    num_threads(num_threads_) if (sets.size() > parallel_threshold_)
+      for (size_t i = 0; i < sets.size(); ++i) {
+        auto id = sets[i];
+        if (covered[id]) continue;
+        covered[id] = 1;
+        ++newly_covered;
+        for (auto v : RR[id]) {
+#pragma omp atomic
+          coverage[v] -= 1;
+        }
+      }
+      uncovered -= newly_covered;
+    }
+
+    double f = double(num_sets_ - uncovered) / num_sets_;
+    return std::make_pair(f, result);
+  }
+
+ private:
+  static constexpr size_t parallel_threshold_ = 1024;
+
+  size_t num_threads_;
+  size_t num_sets_{0};
+  std::vector<uint32_t> counters_;
+  std::vector<std::vector<set_id_type>> index_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_INCREMENTAL_FIND_MOST_INFLUENTIAL_H
@@ -0,0 +1,118 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_LAZY_GREEDY_QUEUE_H
+#define RIPPLES_LAZY_GREEDY_QUEUE_H
+
+#include <cstddef>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace ripples {
+
+//! \brief The priority queue of the lazy-forward (CELF) greedy selection.
+//!
+//! Every candidate is stored with the marginal gain computed at some step.
+//! By submodularity a stale gain is an upper bound of the current one, so
+//! only the candidates reaching the top of the queue need to be evaluated
+//! again.  Ties are broken toward the smallest vertex, as a scan for the
+//! maximum count would do.
+//!
+//! \tparam VertexTy The type of the vertices.
+//! \tparam GainTy The type of the marginal gains.
+template <typename VertexTy, typename GainTy>
+class LazyGreedyQueue {
+  struct Entry {
+    GainTy gain;
+    VertexTy vertex;
+    size_t step;
+
+    bool operator<(const Entry &O) const {
+      return gain < O.gain || (gain == O.gain && vertex > O.vertex);
+    }
+  };
+
+ public:
+  //! \brief Insert a candidate with the gain computed at a given step.
+  void push(VertexTy v, GainTy gain, size_t step) {
+    queue_.push(Entry{gain, v, step});
+  }
+
+  //! \brief Whether the top candidate was evaluated at the given step.
+  bool fresh(size_t step) const {
+    return !queue_.empty() && queue_.top().step == step;
+  }
+
+  //! \brief Remove the top candidate.
+  //!
+  //! \return the vertex and its last gain.
+  std::pair<VertexTy, GainTy> pop() {
+    Entry e = queue_.top();
+    queue_.pop();
+    return std::make_pair(e.vertex, e.gain);
+  }
+
+  //! \brief Remove up to max_candidates stale candidates from the top.
+  //!
+  //! \param max_candidates The maximum number of candidates to remove.
+  //! \param step The current step.
+  //! \return the removed candidates, to be evaluated and pushed back.
+  std::vector<VertexTy> pop_stale(size_t max_candidates, size_t step) {
+    std::vector<VertexTy> result;
+    while (result.size() < max_candidates && !queue_.empty() &&
+           queue_.top().step != step) {
+      result.push_back(queue_.top().vertex);
+      queue_.pop();
+    }
+    return result;
+  }
+
+  bool empty() const { return queue_.empty(); }
+
+ private:
+  std::priority_queue<Entry> queue_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_LAZY_GREEDY_QUEUE_H
@@ -0,0 +1,342 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_LIVE_EDGE_CONDENSATION_H
+#define RIPPLES_LIVE_EDGE_CONDENSATION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "ripples/compressed_edge_mask.h"
+#include "ripples/counter_rng.h"
+
+namespace ripples {
+
+//! \brief The DAG of the strongly connected components of a live-edge graph.
+//!
+//! Components are numbered by Tarjan's algorithm in order of completion, so
+//! every DAG edge goes from a component to one with a smaller index.
+//!
+//! \tparam VertexTy The type of the vertices.
+template <typename VertexTy>
+struct LiveEdgeCondensation {
+  //! The component of every vertex.
+  std::vector<uint32_t> component;
+  //! The number of vertices of every component.
+  std::vector<uint32_t> size;
+  //! CSR index of the vertices of every component.
+  std::vector<size_t> members_index;
+  std::vector<VertexTy> members;
+  //! CSR index of the DAG, without duplicate edges.
+  std::vector<size_t> dag_index;
+  std::vector<uint32_t> dag_edges;
+
+  bool empty() const { return size.empty(); }
+  size_t num_components() const { return size.size(); }
+};
+
+//! \brief Condense a live-edge graph into the DAG of its SCCs.
+//!
+//! Uses an iterative Tarjan's algorithm.
+//!
+//! \param G The input graph.
+//! \param M The mask of the live edges of G.
+//! \return the condensation of the live-edge graph.
+template <typename GraphTy, typename GraphMaskTy>
+LiveEdgeCondensation<typename GraphTy::vertex_type> CondenseLiveEdgeGraph(
+    const GraphTy &G, const GraphMaskTy &M) {
+  using vertex_type = typename GraphTy::vertex_type;
+  constexpr uint32_t unvisited = std::numeric_limits<uint32_t>::max();
+
+  LiveEdgeCondensation<vertex_type> C;
+  const size_t num_nodes = G.num_nodes();
+  auto edge_number = [&](vertex_type v) -> size_t {
+    return std::distance(G.neighbors(0).begin(), G.neighbors(v).begin());
+  };
+
+  C.component.assign(num_nodes, unvisited);
+  std::vector<uint32_t> order(num_nodes, unvisited);
+  std::vector<uint32_t> low(num_nodes);
+  std::vector<vertex_type> stack;
+  // (vertex, next edge number) of the DFS.
+  std::vector<std::pair<vertex_type, size_t>> dfs;
+  uint32_t counter = 0;
+
+  for (vertex_type r = 0; r < num_nodes; ++r) {
+    if (order[r] != unvisited) continue;
+    order[r] = low[r] = counter++;
+    stack.push_back(r);
+    dfs.emplace_back(r, edge_number(r));
+
+    while (!dfs.empty()) {
+      vertex_type v = dfs.back().first;
+      size_t &e = dfs.back().second;
+      size_t end = edge_number(v) + std::distance(G.neighbors(v).begin(),
+                                                  G.neighbors(v).end());
+      bool descended = false;
+      for (e = next_live_edge(M, e, end); e < end;
+           e = next_live_edge(M, e + 1, end)) {
+        vertex_type u = G.neighbors(0).begin()[e].vertex;
+        if (order[u] == unvisited) {
+          order[u] = low[u] = counter++;
+          stack.push_back(u);
+          ++e;
+          dfs.emplace_back(u, edge_number(u));
+          descended = true;
+          break;
+        } else if (C.component[u] == unvisited) {
+          low[v] = std::min(low[v], order[u]);
+        }
+      }
+      if (descended) continue;
+
+      if (low[v] == order[v]) {
+        uint32_t c = C.size.size();
+        uint32_t size = 0;
+        vertex_type u;
+        do {
+          u = stack.back();
+          stack.pop_back();
+          C.component[u] = c;
+          ++size;
+        } while (u != v);
+        C.size.push_back(size);
+      }
+      dfs.pop_back();
+      if (!dfs.empty()) {
+        vertex_type p = dfs.back().first;
+        low[p] = std::min(low[p], low[v]);
+      }
+    }
+  }
+
+  const size_t num_components = C.size.size();
+  C.members_index.assign(num_components + 1, 0);
+  for (size_t c = 0; c < num_components; ++c)
+    C.members_index[c + 1] = C.members_index[c] + C.size[c];
+  C.members.resize(num_nodes);
+  std::vector<size_t> fill(C.members_index.begin(), C.members_index.end() - 1);
+  for (vertex_type v = 0; v < num_nodes; ++v)
+    C.members[fill[C.component[v]]++] = v;
+
+  std::vector<uint32_t> last_source(num_components, unvisited);
+  C.dag_index.assign(num_components + 1, 0);
+  for (uint32_t c = 0; c < num_components; ++c) {
+    for (size_t i = C.members_index[c]; i < C.members_index[c + 1]; ++i) {
+      vertex_type v = C.members[i];
+      size_t first = edge_number(v);
+      size_t last = first + std::distance(G.neighbors(v).begin(),
+                                          G.neighbors(v).end());
+      for_each_live_edge(M, first, last, [&](size_t e) {
+        uint32_t d = C.component[G.neighbors(0).begin()[e].vertex];
+        if (d != c && last_source[d] != c) {
+          last_source[d] = c;
+          C.dag_edges.push_back(d);
+        }
+      });
+    }
+    C.dag_index[c + 1] = C.dag_edges.size();
+  }
+  return C;
+}
+
+//! \brief Reachability counts over the condensation of a live-edge graph.
+//!
+//! Given the components already reached by the seed set, computes for every
+//! other component the number of vertices it reaches that the seed set does
+//! not: exactly, by one DFS per component, when the DAG has at most
+//! exact_limit components or only a few components are asked for, and
+//! otherwise with bottom-k reachability sketches built in one pass over the
+//! DAG in topological order.
+template <typename VertexTy>
+class CondensedReachability {
+ public:
+  //! \brief Constructor.
+  //!
+  //! \param sketch_size The number of ranks kept by every sketch.
+  //! \param exact_limit The largest DAG whose counts are computed exactly.
+  CondensedReachability(size_t sketch_size, size_t exact_limit)
+      : sketch_size_(std::max<size_t>(sketch_size, 2)),
+        exact_limit_(exact_limit) {}
+
+  //! \brief Mark the components reached by a seed set.
+  //!
+  //! \param C The condensation.
+  //! \param begin The start of the seed set.
+  //! \param end The end of the seed set.
+  //! \return the number of vertices reached by the seed set.
+  template <typename Itr>
+  size_t reach(const LiveEdgeCondensation<VertexTy> &C, Itr begin, Itr end) {
+    reached_.assign(C.num_components(), false);
+    std::vector<uint32_t> &queue = scratch_;
+    queue.clear();
+    for (; begin != end; ++begin) {
+      uint32_t c = C.component[*begin];
+      if (reached_[c]) continue;
+      reached_[c] = true;
+      queue.push_back(c);
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < queue.size(); ++i) {
+      uint32_t c = queue[i];
+      count += C.size[c];
+      for (size_t e = C.dag_index[c]; e < C.dag_index[c + 1]; ++e) {
+        uint32_t d = C.dag_edges[e];
+        if (reached_[d]) continue;
+        reached_[d] = true;
+        queue.push_back(d);
+      }
+    }
+    return count;
+  }
+
+  //! \brief Whether a component is reached by the last seed set.
+  bool reached(uint32_t c) const { return reached_[c]; }
+
+  //! \brief The marginal gain of every component.
+  //!
+  //! \param C The condensation.
+  //! \param key The seed of the vertex ranks of the sketches.
+  //! \param components The components whose gains are needed, all of them
+  //! when empty.  Only exact counts take advantage of it.
+  //! \return the (estimated) number of vertices not reached by the seed set
+  //! that every component reaches, zero for the reached ones.
+  const std::vector<double> &gains(
+      const LiveEdgeCondensation<VertexTy> &C, uint64_t key,
+      const std::vector<uint32_t> &components = std::vector<uint32_t>()) {
+    if (C.num_components() <= exact_limit_ || !components.empty())
+      exact_gains(C, components);
+    else
+      sketch_gains(C, key);
+    return gains_;
+  }
+
+ private:
+  void exact_gains(const LiveEdgeCondensation<VertexTy> &C,
+                   const std::vector<uint32_t> &components) {
+    const size_t num_components = C.num_components();
+    gains_.assign(num_components, 0);
+    stamp_.assign(num_components, std::numeric_limits<uint32_t>::max());
+    if (components.empty()) {
+      for (uint32_t c = 0; c < num_components; ++c) exact_gain(C, c);
+    } else {
+      for (uint32_t c : components)
+        if (stamp_[c] != c) exact_gain(C, c);
+    }
+  }
+
+  void exact_gain(const LiveEdgeCondensation<VertexTy> &C, uint32_t c) {
+    if (reached_[c]) return;
+    std::vector<uint32_t> &stack = scratch_;
+    size_t count = 0;
+    stack.assign(1, c);
+    stamp_[c] = c;
+    while (!stack.empty()) {
+      uint32_t x = stack.back();
+      stack.pop_back();
+      count += C.size[x];
+      for (size_t e = C.dag_index[x]; e < C.dag_index[x + 1]; ++e) {
+        uint32_t d = C.dag_edges[e];
+        if (reached_[d] || stamp_[d] == c) continue;
+        stamp_[d] = c;
+        stack.push_back(d);
+      }
+    }
+    gains_[c] = count;
+  }
+
+  void sketch_gains(const LiveEdgeCondensation<VertexTy> &C, uint64_t key) {
+    const size_t num_components = C.num_components();
+    const size_t k = sketch_size_;
+    gains_.assign(num_components, 0);
+    sketches_.assign(num_components * k, 1.0);
+    sketch_length_.assign(num_components, 0);
+
+    std::vector<double> merged;
+    merged.reserve(2 * k);
+    // Successors have smaller indices: they are complete when c is built.
+    for (uint32_t c = 0; c < num_components; ++c) {
+      if (reached_[c]) continue;
+      merged.clear();
+      for (size_t i = C.members_index[c]; i < C.members_index[c + 1]; ++i)
+        merged.push_back(counter_uniform(key, C.members[i]));
+      bottom_k(merged, k);
+      for (size_t e = C.dag_index[c]; e < C.dag_index[c + 1]; ++e) {
+        uint32_t d = C.dag_edges[e];
+        if (reached_[d]) continue;
+        merged.insert(merged.end(), sketches_.begin() + d * k,
+                      sketches_.begin() + d * k + sketch_length_[d]);
+        bottom_k(merged, k);
+      }
+      std::copy(merged.begin(), merged.end(), sketches_.begin() + c * k);
+      sketch_length_[c] = merged.size();
+      // Fewer than k ranks: the sketch holds the whole reachable set.
+      gains_[c] = merged.size() < k ? merged.size() : (k - 1) / merged.back();
+    }
+  }
+
+  //! Keep the k smallest distinct ranks, sorted.
+  static void bottom_k(std::vector<double> &ranks, size_t k) {
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+    if (ranks.size() > k) ranks.resize(k);
+  }
+
+  size_t sketch_size_;
+  size_t exact_limit_;
+  std::vector<bool> reached_;
+  std::vector<double> gains_;
+  std::vector<uint32_t> stamp_;
+  std::vector<uint32_t> scratch_;
+  std::vector<double> sketches_;
+  std::vector<uint32_t> sketch_length_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_LIVE_EDGE_CONDENSATION_H
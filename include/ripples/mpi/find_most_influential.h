@@ -72,7 +72,10 @@ class MPIStreamingFindMostInfluential {
 
  public:
   MPIStreamingFindMostInfluential(const GraphTy &G, RRRsets<GraphTy> &RRRsets,
-                                  size_t num_max_cpu, size_t num_gpus)
+                                  size_t num_max_cpu, size_t num_gpus,
+                                  size_t num_numa_domains = 1,
+                                  const std::vector<uint32_t> *coverage =
+                                      nullptr)
       : num_cpu_workers_(num_max_cpu),
         num_gpu_workers_(num_gpus),
         workers_(),
@@ -113,7 +116,8 @@ class MPIStreamingFindMostInfluential {
 
     workers_.push_back(new CPUFindMostInfluentialWorker<GraphTy>(
         vertex_coverage_, queue_storage_, RRRsets_.begin(), RRRsets_.end(),
-        num_cpu_workers_, d_cpu_counters_));
+        num_cpu_workers_, d_cpu_counters_, num_numa_domains,
+        num_gpu_workers_ == 0 ? coverage : nullptr));
 #ifdef RIPPLES_ENABLE_CUDA
     if (num_gpu_workers_ == 0) return;
 
@@ -507,7 +511,8 @@ auto FindMostInfluentialSet(const GraphTy &G, size_t k,
 template <typename GraphTy, typename ConfTy, typename RRRset>
 auto FindMostInfluentialSet(const GraphTy &G, const ConfTy &CFG,
                             std::vector<RRRset> &RRRsets, bool enableGPU,
-                            mpi_omp_parallel_tag &&ex_tag) {
+                            mpi_omp_parallel_tag &&ex_tag,
+                            const std::vector<uint32_t> *coverage = nullptr) {
   size_t num_gpu = 0;
   size_t num_max_cpu = 0;
 #pragma omp single
@@ -520,7 +525,8 @@ auto FindMostInfluentialSet(const GraphTy &G, const ConfTy &CFG,
     num_gpu = std::min(cuda_num_devices(), CFG.seed_select_max_gpu_workers);
   }
 #endif
-  MPIStreamingFindMostInfluential<GraphTy> SE(G, RRRsets, num_max_cpu, num_gpu);
+  MPIStreamingFindMostInfluential<GraphTy> SE(G, RRRsets, num_max_cpu, num_gpu,
+                                              CFG.numa_domains, coverage);
   return SE.find_most_influential_set(CFG.k);
 }
 
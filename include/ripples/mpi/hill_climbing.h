@@ -49,8 +49,12 @@
 #include "spdlog/spdlog.h"
 
 #include <chrono>
+#include <limits>
+#include <numeric>
 #include "mpi.h"
 
+#include "ripples/lazy_greedy_queue.h"
+
 #define ONE_SIDED 0
 
 namespace ripples {
@@ -115,7 +119,10 @@ class HCCPUCountingWorker : public HCWorker<GraphTy, ItrTy, VItrTy> {
     }
   }
 
-  void setup_build_counters(ItrTy eMask) { eMask_ = eMask; }
+  void setup_build_counters(ItrTy eMask) {
+    eMask_ = eMask;
+    scratch_sample_ = std::numeric_limits<size_t>::max();
+  }
 
   void build_counters(std::atomic<size_t> &mpmc_head, VItrTy B, VItrTy E,
                       size_t sample_id, size_t base,
@@ -141,11 +148,17 @@ class HCCPUCountingWorker : public HCWorker<GraphTy, ItrTy, VItrTy> {
     }
   }
   void batch_counters(VItrTy B, VItrTy E, size_t sample_id, size_t base) {
+    // The frontier is shared by the workers counting the same sample: every
+    // worker traverses a private copy, taken once per sample.
+    if (scratch_sample_ != sample_id) {
+      visited_ = frontier_cache_[sample_id];
+      scratch_sample_ = sample_id;
+    }
     for (vertex_type v = B; v < E; ++v) {
       if (S_.find(v) != S_.end()) continue;
       long count = base;
-      if (!frontier_cache_[sample_id].get(v)) {
-        count = BFS(G_, *eMask_, v, frontier_cache_[sample_id]);
+      if (!visited_.get(v)) {
+        count = base + BFS(G_, *eMask_, v, visited_, touched_);
       }
       count_[v % count_.size()] += count;
     }
@@ -159,6 +172,9 @@ class HCCPUCountingWorker : public HCWorker<GraphTy, ItrTy, VItrTy> {
   const std::set<vertex_type> &S_;
   std::shared_ptr<spdlog::logger> logger_;
   ItrTy eMask_;
+  size_t scratch_sample_{std::numeric_limits<size_t>::max()};
+  Bitmask<int> visited_;
+  std::vector<vertex_type> touched_;
 };
 
 template <typename GraphTy, typename ItrTy, typename VItrTy>
@@ -200,9 +216,8 @@ class HCGPUCountingWorker : public HCWorker<GraphTy, ItrTy, VItrTy> {
     cuda_stream_create(&cuda_stream_);
 
     // allocate host/device memory
-    cuda_malloc((void **)&d_edge_filter_,
-                ((G_.num_edges() / (8 * sizeof(d_vertex_type))) + 1) *
-                    sizeof(d_vertex_type));
+    Bitmask<int> _(G_.num_edges());
+    cuda_malloc((void **)&d_edge_filter_, _.bytes());
 
     // create the solver
     solver_ = new bfs_solver_t(this->G_.num_nodes(), this->G_.num_edges(),
@@ -268,8 +283,7 @@ class HCGPUCountingWorker : public HCWorker<GraphTy, ItrTy, VItrTy> {
     cuda_set_device(ctx_->gpu_id);
     std::vector<d_vertex_type> seeds(S_.begin(), S_.end());
     for (auto itr = B; itr < E; ++itr, ++offset) {
-      cuda_h2d(d_edge_filter_, itr->data(),
-               G_.num_edges() * sizeof(d_vertex_type), cuda_stream_);
+      cuda_h2d(d_edge_filter_, itr->data(), itr->bytes(), cuda_stream_);
 
       d_vertex_type base_count;
       solver_->traverse(seeds.data(), seeds.size(),
@@ -334,12 +348,14 @@ class SeedSelectionEngine {
 
  public:
   SeedSelectionEngine(const GraphTy &G, size_t cpu_workers, size_t gpu_workers,
-                      HillClimbingExecutionRecord &record)
+                      HillClimbingExecutionRecord &record,
+                      const HCCountingOptions &options = HCCountingOptions())
       : G_(G),
         local_count_(),
         global_count_(),
         frontier_cache_(),
         S_(),
+        options_(options),
         logger_(spdlog::stdout_color_mt<spdlog::async_factory>(
             "SeedSelectionEngine")),
         record_(record) {
@@ -432,6 +448,7 @@ class SeedSelectionEngine {
         k, std::vector<std::vector<ex_time_ms>>(workers_.size()));
     frontier_cache_.resize(std::distance(B, E), Bitmask<int>(G_.num_nodes()));
     base_counters_.resize(frontier_cache_.size());
+    if (options_.lazy) return exec_lazy(B, E, k, result);
 
 #if ONE_SIDED
     for (size_t i = 0; i < k; ++i) {
@@ -561,10 +578,109 @@ class SeedSelectionEngine {
   }
 
  private:
+  //! Lazy-forward (CELF) selection.
+  //!
+  //! Every rank holds the same queue, built from the reduced counts, so all
+  //! ranks evaluate the same candidates and select the same seeds.  The
+  //! candidates are counted by the CPU threads, and only their counts are
+  //! reduced.
+  std::vector<vertex_type> exec_lazy(ItrTy B, ItrTy E, size_t k,
+                                     std::vector<vertex_type> &result) {
+    LazyGreedyQueue<vertex_type, long> queue;
+    std::vector<vertex_type> candidates;
+    std::vector<long> counts;
+    for (size_t i = 0; i < k; ++i) {
+      // Every vertex is already a seed when k is larger than the graph.
+      if (i != 0 && queue.empty()) {
+        logger_->warn("No candidates left after {} seeds", i);
+        break;
+      }
+      auto start_frontier = std::chrono::high_resolution_clock::now();
+      if (i != 0) {
+#pragma omp parallel for schedule(dynamic)
+        for (size_t s = 0; s < frontier_cache_.size(); ++s)
+          BFS(G_, *(B + s), S_.begin(), S_.end(), frontier_cache_[s]);
+      }
+      auto end_frontier = std::chrono::high_resolution_clock::now();
+      record_.BuildFrontiersTasks[i][0].push_back(end_frontier -
+                                                  start_frontier);
+
+      std::pair<vertex_type, long> top;
+      if (i == 0) {
+        candidates.resize(G_.num_nodes());
+        std::iota(candidates.begin(), candidates.end(), 0);
+        long base = count_candidates(B, E, candidates, counts);
+        record_.CandidatesPerStep.push_back(candidates.size());
+        for (size_t j = 0; j < candidates.size(); ++j)
+          queue.push(candidates[j], counts[j] - base, i);
+        top = queue.pop();
+      } else {
+        size_t evaluated = 0;
+        for (size_t batch = options_.lazy_batch; !queue.fresh(i); batch *= 2) {
+          candidates = queue.pop_stale(batch, i);
+          long base = count_candidates(B, E, candidates, counts);
+          for (size_t j = 0; j < candidates.size(); ++j)
+            queue.push(candidates[j], counts[j] - base, i);
+          evaluated += candidates.size();
+        }
+        record_.CandidatesPerStep.push_back(evaluated);
+        top = queue.pop();
+      }
+      logger_->trace("Adding vertex {} (gain {})", top.first, top.second);
+      S_.insert(top.first);
+      result.push_back(top.first);
+    }
+    logger_->trace("End Seed Selection");
+    return result;
+  }
+
+  //! Count the candidates over the local samples and reduce the counts.
+  //!
+  //! \return the total number of vertices reached by the seed set.
+  long count_candidates(ItrTy B, ItrTy E,
+                        const std::vector<vertex_type> &candidates,
+                        std::vector<long> &counts) {
+    std::vector<long> local(candidates.size() + 1, 0);
+#pragma omp parallel
+    {
+      std::vector<long> thread_local_counts(local.size(), 0);
+      std::vector<vertex_type> touched;
+      // Each sample belongs to one thread: its frontier is traversed in
+      // place and restored by BFS.
+#pragma omp for schedule(dynamic)
+      for (size_t s = 0; s < frontier_cache_.size(); ++s) {
+        Bitmask<int> &frontier = frontier_cache_[s];
+        long base = frontier.popcount();
+        thread_local_counts.back() += base;
+        for (size_t j = 0; j < candidates.size(); ++j) {
+          vertex_type v = candidates[j];
+          thread_local_counts[j] +=
+              frontier.get(v) ? base
+                              : base + BFS(G_, *(B + s), v, frontier, touched);
+        }
+      }
+#pragma omp critical
+      for (size_t j = 0; j < local.size(); ++j)
+        local[j] += thread_local_counts[j];
+    }
+
+    auto start_reduction = std::chrono::high_resolution_clock::now();
+    counts.resize(local.size());
+    MPI_Allreduce(local.data(), counts.data(), local.size(), MPI_LONG, MPI_SUM,
+                  MPI_COMM_WORLD);
+    auto end_reduction = std::chrono::high_resolution_clock::now();
+    record_.NetworkReductions.push_back(end_reduction - start_reduction);
+
+    long base = counts.back();
+    counts.pop_back();
+    return base;
+  }
+
   const GraphTy &G_;
   std::vector<long> local_count_;
   std::vector<long> global_count_;
   std::set<vertex_type> S_;
+  HCCountingOptions options_;
   HillClimbingExecutionRecord &record_;
   // size_t gpu_workers_;
   // size_t cpu_workers_;
@@ -593,7 +709,8 @@ auto SeedSelection(GraphTy &G, GraphMaskItrTy B, GraphMaskItrTy E, ConfigTy CFG,
   using vertex_type = typename GraphTy::vertex_type;
 
   mpi::SeedSelectionEngine<GraphTy, GraphMaskItrTy> countingEngine(
-      G, CFG.streaming_workers, CFG.streaming_gpu_workers, record);
+      G, CFG.streaming_workers, CFG.streaming_gpu_workers, record,
+      CFG.counting_options());
 
   auto start = std::chrono::high_resolution_clock::now();
   auto S = countingEngine.exec(B, E, CFG.k);
@@ -45,6 +45,7 @@
 
 #include "mpi.h"
 
+#include <cassert>
 #include <cstddef>
 #include <utility>
 #include <vector>
@@ -89,6 +90,26 @@ inline size_t ThetaPrime(ssize_t x, double epsilonPrime, double l, size_t k,
          1;
 }
 
+//! The number of RRR sets assigned to the current rank when a global sample
+//! of size total is interleaved over the MPI ranks.
+//!
+//! Rank r owns the global indices r, r + world_size, r + 2 * world_size, ...
+//! so that the union over the ranks is exactly the first total indices.
+//!
+//! \param total The number of RRR sets to sample across all the ranks.
+inline size_t RankShare(size_t total) {
+  int world_rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  int world_size;
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+  assert(world_rank >= 0 && world_size > 0);
+  size_t rank = world_rank, size = world_size;
+
+  if (total <= rank) return 0;
+  return (total - rank + size - 1) / size;
+}
+
 //! Split a random number generator into one sequence per MPI rank.
 //!
 //! \tparam PRNG The type of the random number generator.
@@ -162,8 +183,12 @@ auto Sampling(const GraphTy &G, const ConfTy &CFG, double l,
   size_t thetaPrime = 0;
   for (ssize_t x = 1; x < std::log2(G.num_nodes()); ++x) {
     // Equation 9
-    ssize_t thetaPrime = ThetaPrime(x, epsilonPrime, l, k, G.num_nodes(),
-                                    mpi_omp_parallel_tag{});
+    ssize_t thetaPrime =
+        generator.isDeterministic()
+            ? RankShare(ThetaPrime(x, epsilonPrime, l, k, G.num_nodes(),
+                                   omp_parallel_tag{}))
+            : ThetaPrime(x, epsilonPrime, l, k, G.num_nodes(),
+                         mpi_omp_parallel_tag{});
 
     size_t delta = thetaPrime - RR.size();
     record.ThetaPrimeDeltas.push_back(thetaPrime - RR.size());
@@ -183,7 +208,8 @@ auto Sampling(const GraphTy &G, const ConfTy &CFG, double l,
     auto timeMostInfluential = measure<>::exec_time([&]() {
       const auto &S =
           FindMostInfluentialSet(G, CFG, RR, generator.isGpuEnabled(),
-                                 typename ExTagTrait::seed_selection_ex_tag{});
+                                 typename ExTagTrait::seed_selection_ex_tag{},
+                                 generator.coverage());
       f = S.first;
     });
     record.ThetaEstimationMostInfluential.push_back(timeMostInfluential);
@@ -199,7 +225,8 @@ auto Sampling(const GraphTy &G, const ConfTy &CFG, double l,
   MPI_Comm_size(MPI_COMM_WORLD, &world_size);
 
   size_t theta = Theta(epsilon, l, k, LB, G.num_nodes());
-  size_t thetaLocal = (theta / world_size) + 1;
+  size_t thetaLocal = generator.isDeterministic() ? RankShare(theta)
+                                                  : (theta / world_size) + 1;
   auto end = std::chrono::high_resolution_clock::now();
 
   record.ThetaEstimationTotal = end - start;
@@ -253,7 +280,8 @@ auto IMM(const GraphTy &G, const ConfTy &CFG, double l, GeneratorTy &gen,
   auto start = std::chrono::high_resolution_clock::now();
   const auto &S =
       FindMostInfluentialSet(G, CFG, R, gen.isGpuEnabled(),
-                             typename ExTagTrait::seed_selection_ex_tag{});
+                             typename ExTagTrait::seed_selection_ex_tag{},
+                             gen.coverage());
   auto end = std::chrono::high_resolution_clock::now();
 
   record.FindMostInfluentialSet = end - start;
@@ -0,0 +1,250 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_OPIMC_H
+#define RIPPLES_OPIMC_H
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+
+#include "ripples/find_most_influential.h"
+#include "ripples/generate_rrr_sets.h"
+#include "ripples/imm.h"
+#include "ripples/imm_execution_record.h"
+#include "ripples/incremental_find_most_influential.h"
+#include "ripples/utility.h"
+
+namespace ripples {
+
+//! \brief The configuration data structure for the OPIM-C algorithm.
+//!
+//! OPIM-C shares the streaming engine options of IMM.
+struct OPIMCConfiguration : public IMMConfiguration {
+  //! The failure probability.  When zero, 1/n is used.
+  double delta{0};
+
+  //! \brief Add command line options to configure OPIM-C.
+  //!
+  //! \param app The command-line parser object.
+  void addCmdOptions(CLI::App &app) {
+    IMMConfiguration::addCmdOptions(app);
+    app.add_option("--delta", delta,
+                   "The failure probability (default 1/n).")
+        ->group("Algorithm Options");
+  }
+};
+
+//! OPIM-C execution record.
+struct OPIMCExecutionRecord : public IMMExecutionRecord {
+  //! Number of sampling rounds executed.
+  size_t Rounds{0};
+  //! Upper bound on the maximum number of RRR sets per collection.
+  size_t ThetaMax{0};
+  //! Lower bound on the spread of the solution at each round.
+  std::vector<double> LowerBounds;
+  //! Upper bound on the optimal spread at each round.
+  std::vector<double> UpperBounds;
+  //! Approximation ratio certified at each round.
+  std::vector<double> Ratios;
+};
+
+//! \brief Count the RRR sets covered by a seed set.
+//!
+//! \param num_nodes The number of vertices in the graph.
+//! \param RR The collection of RRR sets.
+//! \param seeds The seed set.
+//!
+//! \return the number of RRR sets containing at least one seed.
+template <typename GraphTy>
+size_t CountCoveredSets(size_t num_nodes, const RRRsets<GraphTy> &RR,
+                        const std::vector<typename GraphTy::vertex_type> &seeds) {
+  std::vector<char> is_seed(num_nodes, 0);
+  for (auto s : seeds) is_seed[s] = 1;
+
+  size_t covered = 0;
+#pragma omp parallel for reduction(+ : covered) schedule(dynamic, 64)
+  for (size_t i = 0; i < RR.size(); ++i) {
+    for (auto v : RR[i]) {
+      if (is_seed[v]) {
+        ++covered;
+        break;
+      }
+    }
+  }
+  return covered;
+}
+
+//! \brief The OPIM-C algorithm for Influence Maximization.
+//!
+//! Two independent collections of RRR sets grow in doubling rounds.  At each
+//! round a greedy solution S is computed on the first collection; its
+//! coverage gives an upper bound on the optimal spread, and the coverage of S
+//! on the second collection a lower bound on the spread of S.  The algorithm
+//! stops as soon as the ratio of the two bounds certifies a
+//! (1 - 1/e - epsilon)-approximation with probability 1 - delta, or when the
+//! collections reach the worst-case size.
+//!
+//! The upper bound used is Cov(S) / (1 - 1/e), which only needs the coverage
+//! returned by the seed selection engine.
+//!
+//! \tparam GraphTy The type of the input graph.
+//! \tparam ConfTy The configuration type.
+//! \tparam GeneratorTy The type of the streaming RRR generator.
+//! \tparam diff_model_tag Type-Tag to select the diffusion model.
+//!
+//! \param G The input graph.  The graph is transposed.
+//! \param CFG The configuration.
+//! \param gen The streaming RRR sets generator.
+//! \param record The execution record.
+//! \param model_tag The diffusion model tag.
+//! \param ex_tag The execution policy tag.
+template <typename GraphTy, typename ConfTy, typename GeneratorTy,
+          typename diff_model_tag>
+auto OPIMC(const GraphTy &G, const ConfTy &CFG, GeneratorTy &gen,
+           OPIMCExecutionRecord &record, diff_model_tag &&model_tag,
+           omp_parallel_tag &&ex_tag) {
+  using vertex_type = typename GraphTy::vertex_type;
+  size_t k = CFG.k;
+  double epsilon = CFG.epsilon;
+  double n = G.num_nodes();
+  double delta = CFG.delta > 0 ? CFG.delta : 1.0 / n;
+  const double approx = 1 - 1 / std::exp(1.0);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  double logBinom = logBinomial(G.num_nodes(), k);
+  double thetaMax =
+      2 * n *
+      std::pow(approx * std::sqrt(std::log(6 / delta)) +
+                   std::sqrt(approx * (logBinom + std::log(6 / delta))),
+               2) /
+      (epsilon * epsilon * k);
+  double theta0 = thetaMax * epsilon * epsilon * k / n;
+  size_t iMax = std::max<size_t>(1, std::ceil(std::log2(thetaMax / theta0)));
+  double a1 = std::log(3 * iMax / delta) + logBinom;
+  double a2 = std::log(3 * iMax / delta);
+  record.ThetaMax = thetaMax;
+
+  RRRsets<GraphTy> R1, R2;
+
+  size_t num_threads(1);
+#pragma omp single
+  num_threads =
+      std::min<size_t>(omp_get_max_threads(), CFG.seed_select_max_workers);
+  std::unique_ptr<IncrementalFindMostInfluential<GraphTy>> selector;
+  if (CFG.incremental_selection)
+    selector.reset(new IncrementalFindMostInfluential<GraphTy>(G, num_threads));
+
+  auto grow = [&](RRRsets<GraphTy> &RR, size_t size) {
+    if (size <= RR.size()) return;
+    size_t delta = size - RR.size();
+    RR.insert(RR.end(), delta, RRRset<GraphTy>{});
+    GenerateRRRSets(G, gen, RR.end() - delta, RR.end(), record,
+                    std::forward<diff_model_tag>(model_tag),
+                    std::forward<omp_parallel_tag>(ex_tag));
+  };
+
+  std::vector<vertex_type> seeds;
+  for (size_t i = 1; i <= iMax; ++i) {
+    size_t theta = std::ceil(theta0 * std::pow(2, i - 1));
+    record.ThetaPrimeDeltas.push_back(2 * (theta - R1.size()));
+
+    auto timeRRRSets = measure<>::exec_time([&]() {
+      grow(R1, theta);
+      grow(R2, theta);
+    });
+    record.ThetaEstimationGenerateRRR.push_back(timeRRRSets);
+
+    // R2 is only appended: partitioning R1 during seed selection is safe.
+    double coverage1;
+    auto timeMostInfluential = measure<>::exec_time([&]() {
+      auto S = selector ? selector->find_most_influential_set(R1, k)
+                        : FindMostInfluentialSet(
+                              G, CFG, R1, record, gen.isGpuEnabled(),
+                              std::forward<omp_parallel_tag>(ex_tag));
+      coverage1 = S.first * R1.size();
+      seeds = std::move(S.second);
+    });
+    record.ThetaEstimationMostInfluential.push_back(timeMostInfluential);
+
+    double coverage2 = CountCoveredSets<GraphTy>(G.num_nodes(), R2, seeds);
+
+    double lower =
+        (std::pow(std::sqrt(coverage2 + 2 * a2 / 9) - std::sqrt(a2 / 2), 2) -
+         a2 / 18) *
+        n / R2.size();
+    double upper =
+        std::pow(std::sqrt(coverage1 / approx + a1 / 2) + std::sqrt(a1 / 2),
+                 2) *
+        n / R1.size();
+    double ratio = lower / upper;
+
+    record.Rounds = i;
+    record.LowerBounds.push_back(lower);
+    record.UpperBounds.push_back(upper);
+    record.Ratios.push_back(ratio);
+
+    if (ratio >= approx - epsilon) break;
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  record.Theta = R1.size() + R2.size();
+  record.ThetaEstimationTotal = end - start;
+  record.FindMostInfluentialSet = std::chrono::duration<double, std::milli>(0);
+  for (auto &t : record.ThetaEstimationMostInfluential)
+    record.FindMostInfluentialSet += t;
+  record.GenerateRRRSets = std::chrono::duration<double, std::milli>(0);
+  for (auto &t : record.ThetaEstimationGenerateRRR)
+    record.GenerateRRRSets += t;
+
+  return seeds;
+}
+
+}  // namespace ripples
+
+#endif  // RIPPLES_OPIMC_H
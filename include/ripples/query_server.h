@@ -0,0 +1,275 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_QUERY_SERVER_H
+#define RIPPLES_QUERY_SERVER_H
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "ripples/imm.h"
+#include "ripples/imm_execution_record.h"
+
+namespace ripples {
+
+//! The configuration of the query server.
+struct QueryServerConfiguration : public IMMConfiguration {
+  std::string socket_path{""};
+
+  //! \brief Add command line options to configure the server.
+  //!
+  //! \param app The command-line parser object.
+  void addCmdOptions(CLI::App &app) {
+    IMMConfiguration::addCmdOptions(app);
+    app.add_option("--socket", socket_path,
+                   "Serve requests on a UNIX socket instead of stdin/stdout.")
+        ->group("Server Options");
+  }
+};
+
+//! \brief Answer influence maximization queries over a pool of RRR sets.
+//!
+//! The pool is kept across queries and grows only when a query needs more
+//! samples than it holds.  Sampling is deterministic, so the pool is always
+//! a prefix of the same global sequence of RRR sets.  Requests and responses
+//! are JSON objects:
+//!
+//!  - {"op": "seeds", "k": 10, "epsilon": 0.5}: the IMM seed set of size k.
+//!  - {"op": "spread", "seeds": [...], "epsilon": 0.05}: the estimated
+//!    influence of a seed set.  The optional epsilon bounds the additive error
+//!    on the fraction of covered RRR sets with probability 1 - 1/n.
+//!  - {"op": "gain", "seeds": [...], "candidate": v}: the marginal gain of
+//!    adding v to the seed set.
+//!  - {"op": "stats"}: the size of the graph and of the pool.
+//!
+//! Vertices use the IDs of the input file.  The "id" of a request, if any, is
+//! copied in the response.  Failures are reported in the "error" field.
+//!
+//! \tparam GraphTy The type of the input graph.
+//! \tparam ConfTy The configuration type.
+//! \tparam GeneratorTy The type of the RRR sets generator.
+//! \tparam diff_model_tag Type-Tag to select the diffusion model.
+template <typename GraphTy, typename ConfTy, typename GeneratorTy,
+          typename diff_model_tag>
+class QueryEngine {
+  using vertex_type = typename GraphTy::vertex_type;
+
+ public:
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.  The graph is transposed.
+  //! \param CFG The configuration.
+  //! \param generator The RRR sets generator, in deterministic mode.
+  //! \param record The execution record the generator writes to.  Nothing
+  //! reads it, so it is cleared at every request instead of growing.
+  QueryEngine(const GraphTy &G, const ConfTy &CFG, GeneratorTy &generator,
+              IMMExecutionRecord &record)
+      : G_(G), CFG_(CFG), generator_(generator), record_(record) {
+#pragma omp single
+    num_threads_ =
+        std::min<size_t>(omp_get_max_threads(), CFG.seed_select_max_workers);
+  }
+
+  //! The number of RRR sets in the pool.
+  size_t num_samples() const { return pool_.size(); }
+
+  //! \brief Answer a request.
+  //!
+  //! \param request The request.
+  //! \return the response.
+  nlohmann::json handle(const nlohmann::json &request) {
+    record_ = IMMExecutionRecord();
+    nlohmann::json response;
+    try {
+      std::string op = request.at("op").get<std::string>();
+      if (op == "seeds")
+        response = seeds(request);
+      else if (op == "spread")
+        response = spread(request);
+      else if (op == "gain")
+        response = gain(request);
+      else if (op == "stats")
+        response = {{"nodes", G_.num_nodes()},
+                    {"edges", G_.num_edges()},
+                    {"samples", pool_.size()}};
+      else
+        response = {{"error", "unknown op " + op}};
+    } catch (const std::exception &e) {
+      response = {{"error", e.what()}};
+    } catch (const char *e) {
+      response = {{"error", e}};
+    }
+    if (request.is_object() && request.count("id"))
+      response["id"] = request["id"];
+    return response;
+  }
+
+ private:
+  nlohmann::json seeds(const nlohmann::json &request) {
+    ConfTy CFG(CFG_);
+    CFG.k = request.value("k", CFG_.k);
+    CFG.epsilon = request.value("epsilon", CFG_.epsilon);
+    if (CFG.k == 0 || CFG.k > G_.num_nodes())
+      throw std::invalid_argument("k out of range");
+    if (CFG.epsilon <= 0) throw std::invalid_argument("epsilon must be > 0");
+
+    double l = 1 + 1 / std::log2(G_.num_nodes());
+    IMMExecutionRecord record;
+    pool_ = Sampling(G_, CFG, l, generator_, record, diff_model_tag{},
+                     omp_parallel_tag{},
+                     static_cast<IncrementalFindMostInfluential<GraphTy> *>(
+                         nullptr),
+                     static_cast<RRRSpillStore<GraphTy> *>(nullptr),
+                     std::move(pool_));
+    auto S = FindMostInfluentialSet(G_, CFG, pool_, record,
+                                    generator_.isGpuEnabled(),
+                                    omp_parallel_tag{}, generator_.coverage());
+
+    std::vector<vertex_type> seeds(S.second);
+    G_.convertID(seeds.begin(), seeds.end(), seeds.begin());
+    return {{"seeds", seeds},
+            {"coverage", S.first},
+            {"spread", S.first * G_.num_nodes()},
+            {"samples", pool_.size()}};
+  }
+
+  nlohmann::json spread(const nlohmann::json &request) {
+    auto mask = seed_mask(request.at("seeds"));
+    grow(request);
+    size_t covered = count_covered(
+        [&](const RRRset<GraphTy> &set) { return covers(set, mask); });
+    return estimate(covered);
+  }
+
+  nlohmann::json gain(const nlohmann::json &request) {
+    auto mask = seed_mask(request.at("seeds"));
+    vertex_type candidate =
+        G_.transformID(request.at("candidate").get<vertex_type>());
+    grow(request);
+    size_t covered = count_covered([&](const RRRset<GraphTy> &set) {
+      return !covers(set, mask) &&
+             std::binary_search(set.begin(), set.end(), candidate);
+    });
+    return estimate(covered);
+  }
+
+  //! Mark the seeds, given with their original IDs.
+  std::vector<char> seed_mask(const nlohmann::json &seeds) const {
+    std::vector<char> mask(G_.num_nodes(), 0);
+    for (auto &s : seeds) mask[G_.transformID(s.get<vertex_type>())] = 1;
+    return mask;
+  }
+
+  static bool covers(const RRRset<GraphTy> &set,
+                     const std::vector<char> &mask) {
+    return std::any_of(set.begin(), set.end(),
+                       [&](vertex_type v) { return mask[v] != 0; });
+  }
+
+  //! \brief Grow the pool to the samples needed by the requested accuracy.
+  //!
+  //! By Hoeffding's inequality, theta samples estimate the covered fraction
+  //! within epsilon with probability 1 - 1/n when
+  //! theta >= ln(2n) / (2 epsilon^2).
+  void grow(const nlohmann::json &request) {
+    size_t samples = request.value("samples", size_t(0));
+    if (request.count("epsilon")) {
+      double epsilon = request["epsilon"].get<double>();
+      if (epsilon <= 0) throw std::invalid_argument("epsilon must be > 0");
+      samples = std::max<size_t>(
+          samples, std::ceil(std::log(2.0 * G_.num_nodes()) /
+                             (2 * epsilon * epsilon)));
+    }
+    samples = std::max<size_t>(samples, 1);
+    if (samples <= pool_.size()) return;
+
+#if defined ENABLE_MEMKIND
+    RRRsetAllocator<vertex_type> allocator(
+        libmemkind::kinds::DAX_KMEM_PREFERRED);
+#elif defined ENABLE_METALL
+    RRRsetAllocator<vertex_type> allocator =
+        metall_manager_instance().get_allocator();
+#else
+    RRRsetAllocator<vertex_type> allocator;
+#endif
+    size_t delta = samples - pool_.size();
+    pool_.insert(pool_.end(), delta, RRRset<GraphTy>(allocator));
+    IMMExecutionRecord record;
+    GenerateRRRSets(G_, generator_, pool_.end() - delta, pool_.end(), record,
+                    diff_model_tag{}, omp_parallel_tag{});
+  }
+
+  template <typename PredicateTy>
+  size_t count_covered(PredicateTy covered) const {
+    size_t count = 0;
+#pragma omp parallel for reduction(+ : count) num_threads(num_threads_) \
+    schedule(dynamic, 256)
+    for (size_t i = 0; i < pool_.size(); ++i) count += covered(pool_[i]);
+    return count;
+  }
+
+  nlohmann::json estimate(size_t covered) const {
+    double f = double(covered) / pool_.size();
+    double error = std::sqrt(std::log(2.0 * G_.num_nodes()) /
+                             (2.0 * pool_.size()));
+    return {{"spread", f * G_.num_nodes()},
+            {"coverage", f},
+            {"error", error * G_.num_nodes()},
+            {"samples", pool_.size()}};
+  }
+
+  const GraphTy &G_;
+  ConfTy CFG_;
+  GeneratorTy &generator_;
+  IMMExecutionRecord &record_;
+  size_t num_threads_{1};
+  RRRsets<GraphTy> pool_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_QUERY_SERVER_H
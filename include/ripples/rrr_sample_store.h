@@ -0,0 +1,269 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_RRR_SAMPLE_STORE_H
+#define RIPPLES_RRR_SAMPLE_STORE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ripples/diffusion_simulation.h"
+#include "ripples/generate_rrr_sets.h"
+
+namespace ripples {
+
+namespace {
+
+inline uint64_t fnv1a(const char *data, size_t size,
+                      uint64_t hash = 0xcbf29ce484222325ULL) {
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+//! FNV-1a over fixed-size blocks hashed in parallel and then folded, so that
+//! the result does not depend on the number of threads.
+inline uint64_t block_fnv1a(const char *data, size_t size, uint64_t hash) {
+  constexpr size_t block_size = 1 << 20;
+  size_t num_blocks = (size + block_size - 1) / block_size;
+  std::vector<uint64_t> blocks(num_blocks);
+#pragma omp parallel for
+  for (size_t b = 0; b < num_blocks; ++b) {
+    size_t first = b * block_size;
+    blocks[b] = fnv1a(data + first, std::min(block_size, size - first));
+  }
+  return fnv1a(reinterpret_cast<const char *>(blocks.data()),
+               blocks.size() * sizeof(uint64_t), hash);
+}
+
+constexpr char rrr_store_magic[8] = {'R', 'I', 'P', 'P', 'L', 'R', 'R', 'R'};
+constexpr uint64_t rrr_store_version = 1;
+
+}  // namespace
+
+//! The name of the diffusion model stored with the RRR sets.
+inline std::string diffusion_model_name(const independent_cascade_tag &) {
+  return "IC";
+}
+
+//! The name of the diffusion model stored with the RRR sets.
+inline std::string diffusion_model_name(const linear_threshold_tag &) {
+  return "LT";
+}
+
+//! \brief Compute a fingerprint of the graph structure.
+//!
+//! The fingerprint covers sizes, CSR index, edges (destinations and weights),
+//! and the mapping to the original vertex IDs.
+//!
+//! \param G The graph.
+//! \return a 64-bit hash of G.
+template <typename GraphTy>
+uint64_t GraphFingerprint(const GraphTy &G) {
+  using edge_type = typename GraphTy::edge_type;
+  uint64_t sizes[2] = {G.num_nodes(), G.num_edges()};
+  uint64_t hash = fnv1a(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+
+  std::vector<uint64_t> index(G.num_nodes() + 1);
+  for (size_t v = 0; v <= G.num_nodes(); ++v)
+    index[v] = std::distance(G.csr_edges(), G.csr_index()[v]);
+  hash = block_fnv1a(reinterpret_cast<const char *>(index.data()),
+                     index.size() * sizeof(uint64_t), hash);
+  hash = block_fnv1a(reinterpret_cast<const char *>(G.csr_edges()),
+                     G.num_edges() * sizeof(edge_type), hash);
+
+  std::vector<typename GraphTy::vertex_type> ids(G.num_nodes());
+  for (size_t v = 0; v < G.num_nodes(); ++v) ids[v] = v;
+  G.convertID(ids.begin(), ids.end(), ids.begin());
+  return block_fnv1a(reinterpret_cast<const char *>(ids.data()),
+                     ids.size() * sizeof(ids[0]), hash);
+}
+
+//! \brief Save a collection of RRR sets for later runs.
+//!
+//! The file stores a header (graph fingerprint, RNG seed, diffusion model,
+//! number of sets), the offsets of the sets, and their vertices.
+//!
+//! \param path The output file.
+//! \param G The graph the RRR sets were sampled from.
+//! \param model The diffusion model.
+//! \param seed The seed of the random number generator.
+//! \param RR The RRR sets.
+template <typename GraphTy>
+void SaveRRRSets(const std::string &path, const GraphTy &G,
+                 const std::string &model, uint64_t seed,
+                 const RRRsets<GraphTy> &RR) {
+  using vertex_type = typename GraphTy::vertex_type;
+  std::ofstream FS(path, std::ios::binary | std::ios::trunc);
+  if (!FS.is_open()) throw std::runtime_error("Unable to open " + path);
+
+  // Fixed-size fields come first; the model name is padded to 8 bytes.
+  uint64_t header[5] = {rrr_store_version, GraphFingerprint(G), seed,
+                        model.size(), RR.size()};
+  FS.write(rrr_store_magic, sizeof(rrr_store_magic));
+  FS.write(reinterpret_cast<const char *>(header), sizeof(header));
+  std::string padded(model);
+  padded.resize((model.size() + 7) / 8 * 8, '\0');
+  FS.write(padded.data(), padded.size());
+
+  std::vector<uint64_t> offsets(RR.size() + 1, 0);
+  for (size_t i = 0; i < RR.size(); ++i)
+    offsets[i + 1] = offsets[i] + RR[i].size();
+  FS.write(reinterpret_cast<const char *>(offsets.data()),
+           offsets.size() * sizeof(uint64_t));
+  for (auto &set : RR)
+    FS.write(reinterpret_cast<const char *>(set.data()),
+             set.size() * sizeof(vertex_type));
+  FS.close();
+  if (!FS) throw std::runtime_error("Failed writing " + path);
+}
+
+//! \brief Read the seed stored with a collection of RRR sets.
+//!
+//! \param path A file written by SaveRRRSets.
+//! \return the seed of the random number generator the sets were sampled
+//! with.
+inline uint64_t LoadRRRSetsSeed(const std::string &path) {
+  std::ifstream FS(path, std::ios::binary);
+  if (!FS.is_open()) throw std::runtime_error("Unable to open " + path);
+
+  char magic[sizeof(rrr_store_magic)];
+  uint64_t header[5];
+  FS.read(magic, sizeof(magic));
+  FS.read(reinterpret_cast<char *>(header), sizeof(header));
+  if (!FS || std::memcmp(magic, rrr_store_magic, sizeof(magic)) != 0)
+    throw std::runtime_error(path + ": not an RRR sets file");
+  if (header[0] != rrr_store_version)
+    throw std::runtime_error(path + ": unsupported version");
+  return header[2];
+}
+
+//! \brief Load a collection of RRR sets saved by SaveRRRSets.
+//!
+//! The file is memory-mapped and its sets copied in parallel.  Loading fails
+//! when the graph, the diffusion model, or the seed do not match.
+//!
+//! \param path The input file.
+//! \param G The graph the RRR sets must have been sampled from.
+//! \param model The expected diffusion model.
+//! \param seed The expected seed of the random number generator.
+//! \return the RRR sets.
+template <typename GraphTy>
+RRRsets<GraphTy> LoadRRRSets(const std::string &path, const GraphTy &G,
+                             const std::string &model, uint64_t seed) {
+  using vertex_type = typename GraphTy::vertex_type;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) throw std::runtime_error("Unable to open " + path);
+  struct stat st;
+  fstat(fd, &st);
+  size_t size = st.st_size;
+  void *map = size != 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)
+                        : MAP_FAILED;
+  close(fd);
+  if (map == MAP_FAILED) throw std::runtime_error("Unable to map " + path);
+  madvise(map, size, MADV_SEQUENTIAL);
+
+  const char *data = static_cast<const char *>(map);
+  auto fail = [&](const std::string &what) {
+    munmap(map, size);
+    throw std::runtime_error(path + ": " + what);
+  };
+
+  uint64_t header[5];
+  if (size < sizeof(rrr_store_magic) + sizeof(header) ||
+      std::memcmp(data, rrr_store_magic, sizeof(rrr_store_magic)) != 0)
+    fail("not an RRR sets file");
+  std::memcpy(header, data + sizeof(rrr_store_magic), sizeof(header));
+  size_t position = sizeof(rrr_store_magic) + sizeof(header);
+  size_t padded_size = (header[3] + 7) / 8 * 8;
+  size_t num_sets = header[4];
+  if (header[0] != rrr_store_version) fail("unsupported version");
+  if (position + padded_size + (num_sets + 1) * sizeof(uint64_t) > size)
+    fail("truncated file");
+
+  std::string stored_model(data + position, header[3]);
+  position += padded_size;
+  if (header[1] != GraphFingerprint(G)) fail("sampled from a different graph");
+  if (stored_model != model) fail("sampled with model " + stored_model);
+  if (header[2] != seed) fail("sampled with a different seed");
+
+  const uint64_t *offsets = reinterpret_cast<const uint64_t *>(data + position);
+  position += (num_sets + 1) * sizeof(uint64_t);
+  if (position + offsets[num_sets] * sizeof(vertex_type) > size)
+    fail("truncated file");
+  const vertex_type *vertices =
+      reinterpret_cast<const vertex_type *>(data + position);
+
+#if defined ENABLE_MEMKIND
+  RRRsetAllocator<vertex_type> allocator(libmemkind::kinds::DAX_KMEM_PREFERRED);
+#elif defined ENABLE_METALL
+  RRRsetAllocator<vertex_type> allocator =
+      metall_manager_instance().get_allocator();
+#else
+  RRRsetAllocator<vertex_type> allocator;
+#endif
+  RRRsets<GraphTy> RR(num_sets, RRRset<GraphTy>(allocator));
+#pragma omp parallel for schedule(dynamic, 1024)
+  for (size_t i = 0; i < num_sets; ++i)
+    RR[i].assign(vertices + offsets[i], vertices + offsets[i + 1]);
+
+  munmap(map, size);
+  return RR;
+}
+
+}  // namespace ripples
+
+#endif  // RIPPLES_RRR_SAMPLE_STORE_H
@@ -0,0 +1,360 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_RRR_SPILL_STORE_H
+#define RIPPLES_RRR_SPILL_STORE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include <omp.h>
+
+#include "ripples/counting.h"
+#include "ripples/find_most_influential.h"
+#include "ripples/generate_rrr_sets.h"
+
+namespace ripples {
+
+//! \brief Out-of-core storage for RRR sets exceeding a memory budget.
+//!
+//! RRR sets are produced in memory.  Once the in-memory collection exceeds
+//! the budget, it is sealed into a chunk file written sequentially in the
+//! spill directory and its memory is released.  A chunk stores the number of
+//! sets, the offsets of the sets, and their vertices.  The store keeps the
+//! occurrence counters of the spilled sets, so that seed selection only
+//! streams the chunks once per selected seed, marking the covered sets in a
+//! bitmap instead of rewriting the files.
+//!
+//! \tparam GraphTy The type of the input graph.
+template <typename GraphTy>
+class RRRSpillStore {
+  using vertex_type = typename GraphTy::vertex_type;
+
+  struct chunk_t {
+    std::string path;
+    size_t first_id;
+    size_t num_sets;
+  };
+
+ public:
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  //! \param directory The directory where chunks are written.
+  //! \param memory_budget The size in bytes of in-memory RRR sets that
+  //! triggers a spill.
+  //! \param num_threads The number of threads used in seed selection.
+  RRRSpillStore(const GraphTy &G, const std::string &directory,
+                size_t memory_budget, size_t num_threads)
+      : directory_(directory),
+        memory_budget_(memory_budget),
+        num_threads_(num_threads),
+        counters_(G.num_nodes(), 0) {}
+
+  RRRSpillStore(const RRRSpillStore &) = delete;
+  RRRSpillStore &operator=(const RRRSpillStore &) = delete;
+
+  ~RRRSpillStore() {
+    for (auto &c : chunks_) std::remove(c.path.c_str());
+  }
+
+  //! The number of RRR sets written to disk.
+  size_t num_sets() const { return num_spilled_; }
+
+  //! The number of bytes written to disk.
+  size_t spilled_bytes() const { return spilled_bytes_; }
+
+  //! The number of chunk files.
+  size_t num_chunks() const { return chunks_.size(); }
+
+  //! \brief Memory used by a collection of RRR sets.
+  static size_t footprint(const RRRsets<GraphTy> &RR) {
+    size_t bytes = RR.capacity() * sizeof(RRRset<GraphTy>);
+#pragma omp parallel for reduction(+ : bytes)
+    for (size_t i = 0; i < RR.size(); ++i)
+      bytes += RR[i].capacity() * sizeof(vertex_type);
+    return bytes;
+  }
+
+  //! \brief How many RRR sets can be generated before checking the budget.
+  //!
+  //! \param RR The RRR sets currently in memory.
+  size_t batch_size(const RRRsets<GraphTy> &RR) const {
+    size_t used = footprint(RR);
+    size_t count = num_spilled_ + RR.size();
+    size_t average =
+        count == 0 ? sizeof(RRRset<GraphTy>) + 16 * sizeof(vertex_type)
+                   : (spilled_bytes_ + used) / count + sizeof(RRRset<GraphTy>);
+    size_t available = used < memory_budget_ ? memory_budget_ - used : 0;
+    return std::max<size_t>(min_batch_size_, available / average);
+  }
+
+  //! Whether the RRR sets in memory exceed the budget.
+  bool over_budget(const RRRsets<GraphTy> &RR) const {
+    return footprint(RR) >= memory_budget_;
+  }
+
+  //! \brief Seal the RRR sets in memory into a new chunk file.
+  //!
+  //! The sets are counted, written, and removed from RR.
+  //!
+  //! \param RR The RRR sets in memory.
+  void spill(RRRsets<GraphTy> &RR) {
+    if (RR.empty()) return;
+
+    CountOccurrencies(RR.begin(), RR.end(), counters_.begin(), counters_.end(),
+                      num_threads_);
+
+    std::vector<uint64_t> offsets(RR.size() + 1, 0);
+    for (size_t i = 0; i < RR.size(); ++i)
+      offsets[i + 1] = offsets[i] + RR[i].size();
+
+    std::stringstream name;
+    name << directory_ << "/ripples-rrr-" << getpid() << "-" << this
+         << "-" << chunks_.size() << ".bin";
+    std::ofstream FS(name.str(), std::ios::binary | std::ios::trunc);
+    if (!FS.is_open())
+      throw std::runtime_error("Unable to open spill file " + name.str());
+
+    uint64_t num_sets = RR.size();
+    FS.write(reinterpret_cast<const char *>(&num_sets), sizeof(uint64_t));
+    FS.write(reinterpret_cast<const char *>(offsets.data()),
+             offsets.size() * sizeof(uint64_t));
+    for (auto &set : RR)
+      FS.write(reinterpret_cast<const char *>(set.data()),
+               set.size() * sizeof(vertex_type));
+    FS.close();
+    if (!FS) throw std::runtime_error("Failed writing spill file " + name.str());
+
+    chunks_.push_back(chunk_t{name.str(), num_spilled_, RR.size()});
+    num_spilled_ += RR.size();
+    spilled_bytes_ += sizeof(uint64_t) * (offsets.size() + 1) +
+                      offsets.back() * sizeof(vertex_type);
+
+    RRRsets<GraphTy>().swap(RR);
+  }
+
+  //! \brief Select k seeds over the spilled and the in-memory RRR sets.
+  //!
+  //! \param RR The RRR sets still in memory.
+  //! \param k The size of the seed set.
+  //!
+  //! \return a pair where the double is the fraction of RRR sets covered and
+  //! the vector the seeds selected.
+  std::pair<double, std::vector<vertex_type>> find_most_influential_set(
+      const RRRsets<GraphTy> &RR, size_t k) {
+    size_t total = num_spilled_ + RR.size();
+    std::vector<uint32_t> coverage(counters_);
+    CountOccurrencies(RR.begin(), RR.end(), coverage.begin(), coverage.end(),
+                      num_threads_);
+
+    std::vector<uint64_t> covered((total + 63) / 64, 0);
+
+    auto cmp = [](const std::pair<vertex_type, uint32_t> &a,
+                  const std::pair<vertex_type, uint32_t> &b) {
+      return a.second < b.second;
+    };
+    std::vector<std::pair<vertex_type, uint32_t>> queue_storage(
+        coverage.size());
+    for (size_t v = 0; v < coverage.size(); ++v)
+      queue_storage[v] = {vertex_type(v), coverage[v]};
+    std::priority_queue<std::pair<vertex_type, uint32_t>,
+                        std::vector<std::pair<vertex_type, uint32_t>>,
+                        decltype(cmp)>
+        queue(cmp, std::move(queue_storage));
+
+    std::vector<vertex_type> result;
+    result.reserve(k);
+    size_t uncovered = total;
+
+    std::vector<uint64_t> offsets;
+    std::vector<vertex_type> vertices;
+    while (result.size() < k && uncovered != 0 && !queue.empty()) {
+      auto element = queue.top();
+      queue.pop();
+
+      if (element.second > coverage[element.first]) {
+        element.second = coverage[element.first];
+        queue.push(element);
+        continue;
+      }
+
+      vertex_type seed = element.first;
+      result.push_back(seed);
+
+      size_t newly_covered = 0;
+      for (auto &chunk : chunks_) {
+        load(chunk, offsets, vertices);
+        newly_covered += cover(
+            seed, chunk.first_id, chunk.num_sets, covered, coverage,
+            [&](size_t i) {
+              return std::make_pair(vertices.data() + offsets[i],
+                                    vertices.data() + offsets[i + 1]);
+            });
+      }
+      newly_covered +=
+          cover(seed, num_spilled_, RR.size(), covered, coverage,
+                [&](size_t i) {
+                  return std::make_pair(RR[i].data(),
+                                        RR[i].data() + RR[i].size());
+                });
+      uncovered -= newly_covered;
+    }
+
+    double f = double(total - uncovered) / total;
+    return std::make_pair(f, result);
+  }
+
+  //! \brief The fraction of spilled and in-memory RRR sets covered by every
+  //! prefix of a seed set.
+  //!
+  //! \param RR The RRR sets still in memory.
+  //! \param seeds The seeds in selection order.
+  //!
+  //! \return the fraction of RRR sets covered by the first j + 1 seeds at
+  //! position j.
+  std::vector<double> prefix_coverage(const RRRsets<GraphTy> &RR,
+                                      const std::vector<vertex_type> &seeds) {
+    std::vector<uint32_t> rank(counters_.size(), seeds.size());
+    for (size_t j = 0; j < seeds.size(); ++j) rank[seeds[j]] = j;
+
+    std::vector<size_t> covered(seeds.size(), 0);
+    std::vector<uint64_t> offsets;
+    std::vector<vertex_type> vertices;
+    for (auto &chunk : chunks_) {
+      load(chunk, offsets, vertices);
+      CountFirstCoveringSeed(
+          chunk.num_sets,
+          [&](size_t i) {
+            return std::make_pair(vertices.data() + offsets[i],
+                                  vertices.data() + offsets[i + 1]);
+          },
+          rank, covered, num_threads_);
+    }
+    CountFirstCoveringSeed(
+        RR.size(),
+        [&](size_t i) {
+          return std::make_pair(RR[i].data(), RR[i].data() + RR[i].size());
+        },
+        rank, covered, num_threads_);
+
+    size_t total_sets = num_spilled_ + RR.size();
+    std::vector<double> fractions(seeds.size());
+    size_t total = 0;
+    for (size_t j = 0; j < seeds.size(); ++j) {
+      total += covered[j];
+      fractions[j] = double(total) / total_sets;
+    }
+    return fractions;
+  }
+
+ private:
+  static constexpr size_t min_batch_size_ = 1024;
+
+  void load(const chunk_t &chunk, std::vector<uint64_t> &offsets,
+            std::vector<vertex_type> &vertices) const {
+    std::ifstream FS(chunk.path, std::ios::binary);
+    if (!FS.is_open())
+      throw std::runtime_error("Unable to open spill file " + chunk.path);
+
+    uint64_t num_sets;
+    FS.read(reinterpret_cast<char *>(&num_sets), sizeof(uint64_t));
+    offsets.resize(num_sets + 1);
+    FS.read(reinterpret_cast<char *>(offsets.data()),
+            offsets.size() * sizeof(uint64_t));
+    vertices.resize(offsets.back());
+    FS.read(reinterpret_cast<char *>(vertices.data()),
+            vertices.size() * sizeof(vertex_type));
+    if (!FS) throw std::runtime_error("Failed reading spill file " + chunk.path);
+  }
+
+  template <typename SetAccessTy>
+  size_t cover(vertex_type seed, size_t first_id, size_t num_sets,
+               std::vector<uint64_t> &covered, std::vector<uint32_t> &coverage,
+               SetAccessTy set) {
+    size_t newly_covered = 0;
+#pragma omp parallel for reduction(+ : newly_covered) \
+    num_threads(num_threads_) schedule(dynamic, 256)
+    for (size_t i = 0; i < num_sets; ++i) {
+      size_t id = first_id + i;
+      uint64_t bit = uint64_t(1) << (id % 64);
+      uint64_t word;
+#pragma omp atomic read
+      word = covered[id / 64];
+      if (word & bit) continue;
+
+      auto range = set(i);
+      if (!std::binary_search(range.first, range.second, seed)) continue;
+
+#pragma omp atomic
+      covered[id / 64] |= bit;
+      ++newly_covered;
+      for (auto itr = range.first; itr != range.second; ++itr) {
+#pragma omp atomic
+        coverage[*itr] -= 1;
+      }
+    }
+    return newly_covered;
+  }
+
+  std::string directory_;
+  size_t memory_budget_;
+  size_t num_threads_;
+  std::vector<uint32_t> counters_;
+  std::vector<chunk_t> chunks_;
+  size_t num_spilled_{0};
+  size_t spilled_bytes_{0};
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_RRR_SPILL_STORE_H
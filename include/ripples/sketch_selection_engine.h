@@ -0,0 +1,261 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_SKETCH_SELECTION_ENGINE_H
+#define RIPPLES_SKETCH_SELECTION_ENGINE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "omp.h"
+
+#include "spdlog/sinks/stdout_color_sinks.h"
+#include "spdlog/spdlog.h"
+
+#include "ripples/bitmask.h"
+#include "ripples/compressed_edge_mask.h"
+#include "ripples/counter_rng.h"
+#include "ripples/hill_climbing_engine.h"
+
+namespace ripples {
+
+//! \brief Approximate hill-climbing seed selection with combined bottom-k
+//! reachability sketches (SKIM).
+//!
+//! Every (vertex, sample) pair gets a random rank, and the pairs are
+//! processed in rank order: a reverse traversal in the sample adds the pair
+//! to the sketch of every vertex reaching it.  The first vertex whose sketch
+//! holds sketch_size pairs is the next seed, with an estimated coverage of
+//! (sketch_size - 1) / rank pairs.  Its forward reach is then marked covered
+//! in every sample, and the covered pairs already processed are removed from
+//! the sketches, so that the following seeds are chosen on the residual
+//! problem.  If the ranks run out first, the sketches hold the exact residual
+//! counts and the vertex with the largest one is chosen.
+//!
+//! The sketch size trades accuracy for time: the relative error of the
+//! estimates is about 1 / sqrt(sketch_size - 2), and a sketch size larger
+//! than the number of pairs gives the exact greedy selection.
+//!
+//! \tparam GraphTy The type of the input graph.
+//! \tparam ItrTy The type of the iterator over the samples.
+template <typename GraphTy, typename ItrTy>
+class SketchSeedSelectionEngine {
+  using vertex_type = typename GraphTy::vertex_type;
+
+ public:
+  using ex_time_ms = std::chrono::duration<double, std::milli>;
+
+  //! \brief Constructor.
+  //!
+  //! \param G The input graph.
+  //! \param sketch_size The number of pairs that makes a sketch full.
+  //! \param key The seed of the ranks.
+  SketchSeedSelectionEngine(const GraphTy &G, size_t sketch_size,
+                            uint64_t key)
+      : G_(G),
+        sketch_size_(std::max<size_t>(sketch_size, 2)),
+        key_(key),
+        in_index_(G.num_nodes() + 1, 0),
+        in_edges_(G.num_edges()),
+        logger_(spdlog::stdout_color_mt("SketchSeedSelectionEngine")) {
+    // The reverse adjacency keeps the forward edge numbers, which index the
+    // samples.
+    auto edges = G.neighbors(0).begin();
+    for (vertex_type v = 0; v < G.num_nodes(); ++v)
+      for (auto &e : G.neighbors(v)) ++in_index_[e.vertex + 1];
+    for (size_t v = 0; v < G.num_nodes(); ++v)
+      in_index_[v + 1] += in_index_[v];
+    std::vector<size_t> fill(in_index_.begin(), in_index_.end() - 1);
+    for (vertex_type v = 0; v < G.num_nodes(); ++v) {
+      size_t e = std::distance(edges, G.neighbors(v).begin());
+      for (auto &n : G.neighbors(v)) in_edges_[fill[n.vertex]++] = {v, e++};
+    }
+  }
+
+  ~SketchSeedSelectionEngine() { spdlog::drop("SketchSeedSelectionEngine"); }
+
+  std::vector<vertex_type> exec(ItrTy B, ItrTy E, size_t k,
+                                std::vector<std::vector<ex_time_ms>> &record) {
+    logger_->trace("Start Sketch Seed Selection");
+    record.resize(1);
+
+    const size_t n = G_.num_nodes();
+    const size_t num_samples = std::distance(B, E);
+    CounterPermutation order(n * num_samples, key_);
+    std::vector<Bitmask<int>> covered(num_samples, Bitmask<int>(n));
+    std::vector<Bitmask<int>> processed(num_samples, Bitmask<int>(n));
+    std::vector<size_t> sketch(n, 0);
+    Bitmask<int> visited(n);
+    std::vector<vertex_type> touched;
+
+    std::vector<vertex_type> result;
+    std::set<vertex_type> S;
+    estimated_gains_.clear();
+    size_t rank = 0;
+    for (size_t i = 0; i < k && i < n; ++i) {
+      auto start = std::chrono::high_resolution_clock::now();
+
+      vertex_type seed = n;
+      while (seed == n && rank < order.size()) {
+        uint64_t pair = order(rank++);
+        size_t s = pair / n;
+        vertex_type u = pair % n;
+        if (covered[s].get(u)) continue;
+        processed[s].set(u);
+        reverse_reach(B[s], u, visited, touched);
+        for (vertex_type v : touched)
+          if (++sketch[v] == sketch_size_ && seed == n) seed = v;
+      }
+
+      double gain;
+      if (seed != n) {
+        gain = double(sketch_size_ - 1) * order.size() / rank;
+      } else {
+        // Every pair is processed: the sketches are the exact residual
+        // counts.
+        seed = 0;
+        while (S.count(seed)) ++seed;
+        for (vertex_type v = seed + 1; v < n; ++v)
+          if (sketch[v] > sketch[seed] && !S.count(v)) seed = v;
+        gain = sketch[seed];
+      }
+      estimated_gains_.push_back(num_samples ? gain / num_samples : 0);
+
+      cover(B, seed, covered, processed, sketch);
+      S.insert(seed);
+      result.push_back(seed);
+
+      auto end = std::chrono::high_resolution_clock::now();
+      record[0].push_back(end - start);
+      logger_->trace("Seed {} : {}[{}] ~ {}", i, seed, G_.convertID(seed),
+                     estimated_gains_.back());
+    }
+
+    logger_->trace("End Sketch Seed Selection");
+    return result;
+  }
+
+  //! The estimated marginal gain of every seed, averaged over the samples.
+  const std::vector<double> &estimated_gains() const {
+    return estimated_gains_;
+  }
+
+ private:
+  //! Collect in touched the vertices reaching u in M, u included.
+  template <typename GraphMaskTy>
+  void reverse_reach(const GraphMaskTy &M, vertex_type u, Bitmask<int> &visited,
+                     std::vector<vertex_type> &touched) const {
+    touched.clear();
+    touched.push_back(u);
+    visited.set(u);
+    for (size_t head = 0; head < touched.size(); ++head) {
+      vertex_type x = touched[head];
+      for (size_t j = in_index_[x]; j < in_index_[x + 1]; ++j) {
+        const auto &in = in_edges_[j];
+        if (M.get(in.second) && visited.test_and_set(in.first))
+          touched.push_back(in.first);
+      }
+    }
+    for (vertex_type x : touched) visited.unset(x);
+  }
+
+  //! \brief Mark covered the pairs reached by seed.
+  //!
+  //! The covered pairs that were already processed leave the sketches of all
+  //! the vertices reaching them.  Covered sets are closed under reachability,
+  //! so those are exactly the vertices the pair was added to.
+  void cover(ItrTy B, vertex_type seed, std::vector<Bitmask<int>> &covered,
+             std::vector<Bitmask<int>> &processed,
+             std::vector<size_t> &sketch) const {
+#pragma omp parallel
+    {
+      Bitmask<int> visited(G_.num_nodes());
+      std::vector<vertex_type> reached, touched;
+      auto edges = G_.neighbors(0).begin();
+
+#pragma omp for schedule(dynamic)
+      for (size_t s = 0; s < covered.size(); ++s) {
+        const auto &M = B[s];
+        Bitmask<int> &C = covered[s];
+        if (!C.test_and_set(seed)) continue;
+        reached.assign(1, seed);
+        for (size_t head = 0; head < reached.size(); ++head) {
+          vertex_type x = reached[head];
+          for_each_live_edge(M, std::distance(edges, G_.neighbors(x).begin()),
+                             std::distance(edges, G_.neighbors(x).end()),
+                             [&](size_t e) {
+                               vertex_type y = edges[e].vertex;
+                               if (C.test_and_set(y)) reached.push_back(y);
+                             });
+        }
+
+        for (vertex_type x : reached) {
+          if (!processed[s].get(x)) continue;
+          reverse_reach(M, x, visited, touched);
+          for (vertex_type v : touched) {
+#pragma omp atomic
+            --sketch[v];
+          }
+        }
+      }
+    }
+  }
+
+  const GraphTy &G_;
+  size_t sketch_size_;
+  uint64_t key_;
+  std::vector<size_t> in_index_;
+  std::vector<std::pair<vertex_type, size_t>> in_edges_;
+  std::vector<double> estimated_gains_;
+  std::shared_ptr<spdlog::logger> logger_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_SKETCH_SELECTION_ENGINE_H
@@ -0,0 +1,212 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_SPREAD_ESTIMATION_H
+#define RIPPLES_SPREAD_ESTIMATION_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <omp.h>
+
+#include "ripples/generate_rrr_sets.h"
+
+namespace ripples {
+
+//! The estimated influence of a seed set.
+struct SpreadEstimate {
+  double Spread;     //!< n times the fraction of covered RRR sets.
+  double Coverage;   //!< The fraction of covered RRR sets.
+  double Lower;      //!< Lower end of the confidence interval on Spread.
+  double Upper;      //!< Upper end of the confidence interval on Spread.
+  size_t Samples;    //!< The number of RRR sets.
+};
+
+//! \brief The quantile function of the standard normal distribution.
+//!
+//! \param p The probability, in (0, 1).
+inline double NormalQuantile(double p) {
+  double low = -40, high = 40;
+  for (size_t i = 0; i < 200; ++i) {
+    double mid = (low + high) / 2;
+    if (0.5 * std::erfc(-mid / std::sqrt(2.0)) < p)
+      low = mid;
+    else
+      high = mid;
+  }
+  return (low + high) / 2;
+}
+
+//! \brief Inverted index over a collection of RRR sets for spread estimation.
+//!
+//! The index maps every vertex to the ids of the RRR sets containing it, in
+//! CSR form.  Evaluating a seed set ORs the lists of the seeds into a bitset
+//! with one bit per RRR set, counting the bits as they are first set, and
+//! then clears only the words it touched.  The cost therefore depends on the
+//! occurrences of the seeds rather than on the size of the collection.  The
+//! bitset is reused across evaluations, so an index must not be evaluated
+//! from several threads at once.
+//!
+//! \tparam GraphTy The type of the input graph.
+template <typename GraphTy>
+class RRRCoverageIndex {
+  using vertex_type = typename GraphTy::vertex_type;
+  using set_id_type = uint32_t;
+
+ public:
+  //! \brief Build the index.
+  //!
+  //! Each thread owns a range of vertices, so that the index is filled
+  //! without synchronization.
+  //!
+  //! \param G The graph the RRR sets were sampled from.
+  //! \param RR The RRR sets.
+  //! \param num_threads The number of threads to use.
+  RRRCoverageIndex(const GraphTy &G, const RRRsets<GraphTy> &RR,
+                   size_t num_threads)
+      : num_sets_(RR.size()),
+        offsets_(G.num_nodes() + 1, 0),
+        bits_((RR.size() + 63) / 64, 0) {
+    assert(RR.size() <= std::numeric_limits<set_id_type>::max());
+    std::vector<size_t> position;
+
+#pragma omp parallel num_threads(num_threads)
+    {
+      size_t num_elements = G.num_nodes();
+      size_t threadnum = omp_get_thread_num(),
+             numthreads = omp_get_num_threads();
+      vertex_type low = num_elements * threadnum / numthreads,
+                  high = num_elements * (threadnum + 1) / numthreads;
+
+      auto range = [&](const RRRset<GraphTy> &set) {
+        auto first = std::lower_bound(set.begin(), set.end(), low);
+        return std::make_pair(first, std::lower_bound(first, set.end(), high));
+      };
+
+      for (auto &set : RR) {
+        auto r = range(set);
+        for (auto itr = r.first; itr != r.second; ++itr)
+          offsets_[*itr + 1] += 1;
+      }
+
+#pragma omp barrier
+#pragma omp single
+      {
+        for (size_t v = 0; v < num_elements; ++v)
+          offsets_[v + 1] += offsets_[v];
+        ids_.resize(offsets_.back());
+        position.assign(offsets_.begin(), offsets_.end() - 1);
+      }
+
+      for (size_t i = 0; i < RR.size(); ++i) {
+        auto r = range(RR[i]);
+        for (auto itr = r.first; itr != r.second; ++itr)
+          ids_[position[*itr]++] = i;
+      }
+    }
+  }
+
+  //! The number of RRR sets indexed.
+  size_t num_sets() const { return num_sets_; }
+
+  //! \brief The number of RRR sets containing at least one seed.
+  //!
+  //! \param begin The start of the seeds, as internal vertex IDs.
+  //! \param end The end of the seeds.
+  template <typename Itr>
+  size_t covered(Itr begin, Itr end) {
+    size_t count = 0;
+    for (auto itr = begin; itr != end; ++itr)
+      for (size_t j = offsets_[*itr]; j < offsets_[*itr + 1]; ++j) {
+        uint64_t &word = bits_[ids_[j] / 64];
+        uint64_t bit = uint64_t(1) << (ids_[j] % 64);
+        if (word & bit) continue;
+        if (word == 0) touched_.push_back(ids_[j] / 64);
+        word |= bit;
+        ++count;
+      }
+
+    for (auto w : touched_) bits_[w] = 0;
+    touched_.clear();
+    return count;
+  }
+
+  //! \brief Estimate the influence of a seed set.
+  //!
+  //! The confidence interval is the Wilson score interval of the covered
+  //! fraction, scaled by the number of vertices.
+  //!
+  //! \param begin The start of the seeds, as internal vertex IDs.
+  //! \param end The end of the seeds.
+  //! \param confidence The confidence level of the interval.
+  template <typename Itr>
+  SpreadEstimate estimate(Itr begin, Itr end, double confidence = 0.95) {
+    if (num_sets_ == 0) return SpreadEstimate{0, 0, 0, 0, 0};
+
+    double n = offsets_.size() - 1;
+    double theta = num_sets_;
+    double f = covered(begin, end) / theta;
+    double z = NormalQuantile((1 + confidence) / 2);
+
+    double denominator = 1 + z * z / theta;
+    double center = (f + z * z / (2 * theta)) / denominator;
+    double half = z / denominator *
+                  std::sqrt(f * (1 - f) / theta + z * z / (4 * theta * theta));
+    return SpreadEstimate{n * f, f, n * std::max(0.0, center - half),
+                          n * std::min(1.0, center + half), num_sets_};
+  }
+
+ private:
+  size_t num_sets_;
+  std::vector<size_t> offsets_;
+  std::vector<set_id_type> ids_;
+  std::vector<uint64_t> bits_;
+  std::vector<set_id_type> touched_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_SPREAD_ESTIMATION_H
@@ -293,12 +293,15 @@ class CPUFindMostInfluentialWorker : public FindMostInfluentialWorker<GraphTy> {
       std::vector<vertex_type> &global_count,
       std::vector<std::pair<vertex_type, size_t>> &queue_storage,
       rrr_set_iterator begin, rrr_set_iterator end, size_t num_threads,
-      uint32_t *d_cpu_counters)
+      uint32_t *d_cpu_counters, size_t num_domains = 1,
+      const std::vector<uint32_t> *initial_count = nullptr)
       : global_count_(global_count),
         queue_storage_(queue_storage),
         begin_(begin),
         end_(end),
         num_threads_(num_threads),
+        num_domains_(num_domains),
+        initial_count_(initial_count),
         d_cpu_counters_(d_cpu_counters) {}
 
   virtual ~CPUFindMostInfluentialWorker() {}
@@ -313,8 +316,15 @@ class CPUFindMostInfluentialWorker : public FindMostInfluentialWorker<GraphTy> {
   void set_first_rrr_set(rrr_set_iterator I) { begin_ = I; }
 
   void InitialCount() {
-    CountOccurrencies(begin_, end_, global_count_.begin(), global_count_.end(),
-                      num_threads_);
+    if (initial_count_ != nullptr) {
+      // Counters maintained while generating the RRR sets.
+#pragma omp parallel for simd num_threads(num_threads_)
+      for (size_t i = 0; i < global_count_.size(); ++i)
+        global_count_[i] = (*initial_count_)[i];
+    } else {
+      CountOccurrencies(begin_, end_, global_count_.begin(),
+                        global_count_.end(), num_threads_, num_domains_);
+    }
 
     // We have GPU workers so we won't use the heap.
     if (d_cpu_counters_ != nullptr) return;
@@ -339,7 +349,7 @@ class CPUFindMostInfluentialWorker : public FindMostInfluentialWorker<GraphTy> {
 #pragma omp parallel for simd num_threads(num_threads_)
       for (size_t i = 0; i < global_count_.size(); ++i) global_count_[i] = 0;
       CountOccurrencies(begin_, itr, global_count_.begin(), global_count_.end(),
-                        num_threads_);
+                        num_threads_, num_domains_);
     }
     end_ = itr;
   }
@@ -362,6 +372,8 @@ class CPUFindMostInfluentialWorker : public FindMostInfluentialWorker<GraphTy> {
   rrr_set_iterator begin_;
   rrr_set_iterator end_;
   size_t num_threads_;
+  size_t num_domains_;
+  const std::vector<uint32_t> *initial_count_;
   uint32_t *d_cpu_counters_;
 };
 
@@ -394,7 +406,9 @@ class StreamingFindMostInfluential {
 
  public:
   StreamingFindMostInfluential(const GraphTy &G, RRRsets<GraphTy> &RRRsets,
-                               size_t num_max_cpus, size_t num_gpus)
+                               size_t num_max_cpus, size_t num_gpus,
+                               size_t num_numa_domains = 1,
+                               const std::vector<uint32_t> *coverage = nullptr)
       : num_cpu_workers_(num_max_cpus),
         num_gpu_workers_(num_gpus),
         workers_(),
@@ -430,7 +444,8 @@ class StreamingFindMostInfluential {
 
     workers_.push_back(new CPUFindMostInfluentialWorker<GraphTy>(
         vertex_coverage_, queue_storage_, RRRsets_.begin(), RRRsets_.end(),
-        num_cpu_workers_, d_cpu_counters_));
+        num_cpu_workers_, d_cpu_counters_, num_numa_domains,
+        num_gpu_workers_ == 0 ? coverage : nullptr));
 #ifdef RIPPLES_ENABLE_CUDA
     if (num_gpu_workers_ == 0) return;
 
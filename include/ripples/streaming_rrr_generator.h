@@ -43,6 +43,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <memory>
 #include <sstream>
@@ -63,10 +64,6 @@
 #include "ripples/cuda/from_nvgraph/imm/bfs.hxx"
 #endif
 
-#if CUDA_PROFILE
-#include <chrono>
-#endif
-
 namespace ripples {
 
 int streaming_command_line(std::unordered_map<size_t, size_t> &worker_to_gpu,
@@ -148,26 +145,101 @@ class CPUWalkWorker : public WalkWorker<GraphTy, ItrTy> {
   using vertex_t = typename GraphTy::vertex_type;
 
  public:
-  CPUWalkWorker(const GraphTy &G, const PRNGeneratorTy &rng)
-      : WalkWorker<GraphTy, ItrTy>(G), rng_(rng), u_(0, G.num_nodes()) {}
+  CPUWalkWorker(const GraphTy &G, const PRNGeneratorTy &rng,
+                size_t num_workers = 1)
+      : WalkWorker<GraphTy, ItrTy>(G),
+        graph_(&G),
+        rng_(rng),
+        u_(0, G.num_nodes()),
+        num_workers_(num_workers) {}
+
+  //! \brief Traverse a replica of the input graph.
+  //!
+  //! \param G A copy of the graph allocated close to the worker.
+  void graph(const GraphTy &G) { graph_ = &G; }
+
+  //! \brief Count the occurrencies of vertices in the RRR sets produced.
+  void fused_counting() { fused_counting_ = true; }
+
+  //! The occurrencies of each vertex in the RRR sets produced so far.
+  const std::vector<uint32_t> &counts() const { return counts_; }
+
+  //! \brief Sample each RRR set from a stream derived from its index.
+  //!
+  //! \param master_rng The generator from which every stream is derived.
+  //! \param first_index The global index of the first set to be generated.
+  //! \param index_stride The distance between the global indices of two
+  //! consecutive sets.
+  void deterministic_streams(const PRNGeneratorTy &master_rng,
+                             size_t first_index, size_t index_stride) {
+    deterministic_ = true;
+    master_rng_ = master_rng;
+    first_index_ = first_index;
+    index_stride_ = index_stride;
+  }
 
   void svc_loop(std::atomic<size_t> &mpmc_head, ItrTy begin, ItrTy end) {
+    // The histogram is first touched by the thread running the worker.
+    if (fused_counting_ && counts_.empty())
+      counts_.assign(graph_->num_nodes(), 0);
+
+    size_t size = std::distance(begin, end);
     size_t offset = 0;
-    while ((offset = mpmc_head.fetch_add(batch_size_)) <
-           std::distance(begin, end)) {
+    while ((offset = mpmc_head.load(std::memory_order_relaxed)) < size) {
+      // Guided scheduling: large chunks while there is plenty of work to
+      // keep the contention on the head low, small chunks near the end to
+      // reduce the imbalance caused by the last (possibly large) RRR sets.
+      size_t chunk = (size - offset) / (chunk_factor_ * num_workers_);
+      chunk = std::max(min_batch_size_, std::min(chunk, max_batch_size_));
+
+      if ((offset = mpmc_head.fetch_add(chunk)) >= size) break;
+
       auto first = begin;
       std::advance(first, offset);
       auto last = first;
-      std::advance(last, batch_size_);
-      if (last > end) last = end;
-      batch(first, last);
+      std::advance(last, std::min(chunk, size - offset));
+      if (deterministic_)
+        deterministic_batch(first, last, first_index_ + offset * index_stride_);
+      else
+        batch(first, last);
     }
   }
 
  private:
-  static constexpr size_t batch_size_ = 32;
+  static constexpr size_t min_batch_size_ = 4;
+  static constexpr size_t max_batch_size_ = 1024;
+  static constexpr size_t chunk_factor_ = 4;
+  //! log2 of the number of draws reserved to the stream of each RRR set.
+  static constexpr size_t stream_spacing_ = 32;
+  const GraphTy *graph_;
   PRNGeneratorTy rng_;
   trng::uniform_int_dist u_;
+  size_t num_workers_;
+
+  bool deterministic_{false};
+  PRNGeneratorTy master_rng_;
+  size_t first_index_{0};
+  size_t index_stride_{1};
+
+  bool fused_counting_{false};
+  std::vector<uint32_t> counts_;
+
+  void count(const typename std::iterator_traits<ItrTy>::value_type &set) {
+    if (!fused_counting_) return;
+    for (auto v : set) ++counts_[v];
+  }
+
+  void deterministic_batch(ItrTy first, ItrTy last, size_t index) {
+    for (; first != last; ++first, index += index_stride_) {
+      auto local_rng = master_rng_;
+      local_rng.jump(static_cast<unsigned long long>(index) << stream_spacing_);
+      auto local_u = u_;
+
+      vertex_t root = local_u(local_rng);
+      AddRRRSet(*graph_, root, local_rng, *first, diff_model_tag{});
+      count(*first);
+    }
+  }
 
   void batch(ItrTy first, ItrTy last) {
 #if CUDA_PROFILE
@@ -179,7 +251,8 @@ class CPUWalkWorker : public WalkWorker<GraphTy, ItrTy> {
     for (;first != last; ++first) {
       vertex_t root = local_u(local_rng);
 
-      AddRRRSet(this->G_, root, local_rng, *first, diff_model_tag{});
+      AddRRRSet(*graph_, root, local_rng, *first, diff_model_tag{});
+      count(*first);
     }
 
     rng_ = local_rng;
@@ -657,6 +730,8 @@ class StreamingRRRGenerator {
                         const std::unordered_map<size_t, size_t> &worker_to_gpu)
       : num_cpu_workers_(num_cpu_workers),
         num_gpu_workers_(num_gpu_workers),
+        G_(&G),
+        master_rng_(master_rng),
         record_(record),
         console(spdlog::get("Streaming Generator")) {
     if (!console) {
@@ -713,7 +788,10 @@ class StreamingRRRGenerator {
         console->info("cpu_worker_id = {}", cpu_worker_id);
         auto rng = master_rng;
         rng.split(num_rng_sequences, cpu_worker_id);
-        workers.push_back(new cpu_worker_t(G, rng));
+        auto w =
+            new cpu_worker_t(G, rng, num_cpu_workers_ + num_gpu_workers_);
+        workers.push_back(w);
+        cpu_workers_.push_back(w);
         ++cpu_worker_id;
       }
     }
@@ -730,7 +808,18 @@ class StreamingRRRGenerator {
         cuda_contexts_(std::move(O.cuda_contexts_)),
 #endif
         workers(std::move(O.workers)),
+        cpu_workers_(std::move(O.cpu_workers_)),
         mpmc_head(O.mpmc_head.load()),
+        G_(O.G_),
+        numa_domains_(O.numa_domains_),
+        replicas_(std::move(O.replicas_)),
+        fused_counting_(O.fused_counting_),
+        coverage_(std::move(O.coverage_)),
+        master_rng_(O.master_rng_),
+        deterministic_(O.deterministic_),
+        index_offset_(O.index_offset_),
+        index_stride_(O.index_stride_),
+        num_generated_(O.num_generated_),
 #if CUDA_PROFILE
         prof_bd(std::move(O.prof_bd)),
 #endif
@@ -780,6 +869,90 @@ class StreamingRRRGenerator {
 
   IMMExecutionRecord &execution_record() { return record_; }
 
+  //! \brief Make the generated RRR sets independent of the scheduling.
+  //!
+  //! The j-th RRR set produced by this generator is sampled from a stream
+  //! obtained jumping ahead the master generator to the position reserved to
+  //! the global index index_offset + j * index_stride.  The output is then
+  //! the same for any number of workers and any interleaving of the batches.
+  //! MPI ranks can use index_offset = rank and index_stride = world size to
+  //! partition the same global sequence of RRR sets.
+  //!
+  //! \param index_offset The global index of the first RRR set.
+  //! \param index_stride The distance between consecutive global indices.
+  void enable_deterministic_sampling(size_t index_offset = 0,
+                                     size_t index_stride = 1) {
+    assert(num_gpu_workers_ == 0 &&
+           "Deterministic sampling is supported only by CPU workers.");
+    deterministic_ = true;
+    index_offset_ = index_offset;
+    index_stride_ = index_stride;
+  }
+
+  bool isDeterministic() const { return deterministic_; }
+
+  //! \brief Spread the walk workers over NUMA domains.
+  //!
+  //! Workers are bound to the OpenMP places with proc_bind(spread), so that
+  //! with OMP_PLACES=sockets consecutive blocks of workers share a socket.
+  //! Each generate() call splits the output range in one contiguous arena per
+  //! domain.  The workers of a domain fill their arena first and then help
+  //! the other domains.
+  //!
+  //! \param num_domains The number of NUMA domains.
+  //! \param replicate_graph When true, every domain traverses its own copy
+  //! of the input graph, allocated by a thread bound to the domain.
+  void enable_numa(size_t num_domains, bool replicate_graph) {
+    assert(num_gpu_workers_ == 0 &&
+           "NUMA mode is supported only by CPU workers.");
+    numa_domains_ = std::max<size_t>(1, std::min(num_domains, num_cpu_workers_));
+    if (numa_domains_ == 1 || !replicate_graph) return;
+
+    replicas_.resize(numa_domains_);
+#pragma omp parallel num_threads(numa_domains_) proc_bind(spread)
+    {
+      size_t domain = omp_get_thread_num();
+      replicas_[domain].reset(new GraphTy(*G_));
+    }
+
+    for (size_t i = 0; i < cpu_workers_.size(); ++i)
+      cpu_workers_[i]->graph(*replicas_[numa_domain(i)]);
+    console->info("Replicated the graph on {} NUMA domains", numa_domains_);
+  }
+
+  //! \brief Count the occurrencies of vertices while generating RRR sets.
+  //!
+  //! Every worker updates a private histogram as it produces each set.  The
+  //! histograms are summed at the end of every generate() call, so that seed
+  //! selection can start from the totals instead of counting again the RRR
+  //! sets produced in previous rounds.
+  void enable_fused_counting() {
+    assert(num_gpu_workers_ == 0 &&
+           "Fused counting is supported only by CPU workers.");
+    fused_counting_ = true;
+    coverage_.assign(G_->num_nodes(), 0);
+    for (auto &w : cpu_workers_) w->fused_counting();
+  }
+
+  //! \brief The occurrencies of each vertex in the RRR sets generated so far.
+  //!
+  //! \return A pointer to the counters or nullptr when fused counting is not
+  //! enabled.
+  const std::vector<uint32_t> *coverage() const {
+    return fused_counting_ ? &coverage_ : nullptr;
+  }
+
+  //! The number of RRR sets generated so far.
+  size_t num_generated() const { return num_generated_; }
+
+  //! \brief Account for RRR sets obtained elsewhere, e.g., loaded from disk.
+  //!
+  //! In deterministic mode the next generated set continues the global
+  //! sequence after the n skipped ones.
+  //!
+  //! \param n The number of RRR sets to skip.
+  void skip(size_t n) { num_generated_ += n; }
+
   void generate(ItrTy begin, ItrTy end) {
 #if CUDA_PROFILE
     auto start = std::chrono::high_resolution_clock::now();
@@ -789,12 +962,41 @@ class StreamingRRRGenerator {
 
     mpmc_head.store(0);
 
+    using clock = std::chrono::high_resolution_clock;
+    std::vector<clock::time_point> finish(num_cpu_workers_ + num_gpu_workers_);
+
+    if (numa_domains_ > 1) {
+      numa_generate(begin, end, finish);
+    } else {
+      if (deterministic_) {
+        for (auto &w : cpu_workers_)
+          w->deterministic_streams(
+              master_rng_, index_offset_ + num_generated_ * index_stride_,
+              index_stride_);
+      }
+
 #pragma omp parallel num_threads(num_cpu_workers_ + num_gpu_workers_)
-    {
-      size_t rank = omp_get_thread_num();
-      workers[rank]->svc_loop(mpmc_head, begin, end);
+      {
+        size_t rank = omp_get_thread_num();
+        workers[rank]->svc_loop(mpmc_head, begin, end);
+        finish[rank] = clock::now();
+      }
+    }
+    num_generated_ += std::distance(begin, end);
+
+    if (fused_counting_) {
+#pragma omp parallel for schedule(static)
+      for (size_t v = 0; v < coverage_.size(); ++v) {
+        uint32_t sum = 0;
+        for (auto &w : cpu_workers_) sum += w->counts()[v];
+        coverage_[v] = sum;
+      }
     }
 
+    auto join = clock::now();
+    record_.WalkWorkersIdle.emplace_back();
+    for (auto &f : finish) record_.WalkWorkersIdle.back().push_back(join - f);
+
 #if CUDA_PROFILE
     auto d = std::chrono::duration_cast<std::chrono::nanoseconds>(
         std::chrono::high_resolution_clock::now() - start);
@@ -810,6 +1012,43 @@ class StreamingRRRGenerator {
   bool isGpuEnabled() const { return num_gpu_workers_ != 0; }
 
  private:
+  //! The NUMA domain of the i-th worker under proc_bind(spread).
+  size_t numa_domain(size_t i) const {
+    return i * numa_domains_ / num_cpu_workers_;
+  }
+
+  template <typename TimePointTy>
+  void numa_generate(ItrTy begin, ItrTy end, std::vector<TimePointTy> &finish) {
+    // Arenas are proportional to the number of workers in each domain.
+    size_t size = std::distance(begin, end);
+    std::vector<size_t> bounds(numa_domains_ + 1);
+    for (size_t d = 0; d <= numa_domains_; ++d) {
+      size_t first_worker =
+          (d * num_cpu_workers_ + numa_domains_ - 1) / numa_domains_;
+      bounds[d] = size * first_worker / num_cpu_workers_;
+    }
+    std::unique_ptr<std::atomic<size_t>[]> heads(
+        new std::atomic<size_t>[numa_domains_]);
+    for (size_t d = 0; d < numa_domains_; ++d) heads[d].store(0);
+
+#pragma omp parallel num_threads(num_cpu_workers_) proc_bind(spread)
+    {
+      size_t rank = omp_get_thread_num();
+      size_t domain = numa_domain(rank);
+      for (size_t i = 0; i < numa_domains_; ++i) {
+        size_t d = (domain + i) % numa_domains_;
+        if (deterministic_)
+          cpu_workers_[rank]->deterministic_streams(
+              master_rng_,
+              index_offset_ + (num_generated_ + bounds[d]) * index_stride_,
+              index_stride_);
+        cpu_workers_[rank]->svc_loop(heads[d], begin + bounds[d],
+                                     begin + bounds[d + 1]);
+      }
+      finish[rank] = std::chrono::high_resolution_clock::now();
+    }
+  }
+
   size_t num_cpu_workers_, num_gpu_workers_;
   size_t max_batch_size_;
   std::shared_ptr<spdlog::logger> console;
@@ -817,8 +1056,21 @@ class StreamingRRRGenerator {
   std::unordered_map<size_t, std::shared_ptr<cuda_ctx<GraphTy>>> cuda_contexts_;
 #endif
   std::vector<worker_t *> workers;
+  std::vector<cpu_worker_t *> cpu_workers_;
   std::atomic<size_t> mpmc_head{0};
 
+  const GraphTy *G_;
+  size_t numa_domains_{1};
+  std::vector<std::unique_ptr<GraphTy>> replicas_;
+  bool fused_counting_{false};
+  std::vector<uint32_t> coverage_;
+
+  PRNGeneratorTy master_rng_;
+  bool deterministic_{false};
+  size_t index_offset_{0};
+  size_t index_stride_{1};
+  size_t num_generated_{0};
+
 #if CUDA_PROFILE
   struct iter_profile_t {
     iter_profile_t(size_t n, std::chrono::nanoseconds d) : n_(n), d_(d) {}
@@ -0,0 +1,123 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RIPPLES_VECTORIZED_IC_SAMPLER_H
+#define RIPPLES_VECTORIZED_IC_SAMPLER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ripples/bitmask.h"
+#include "ripples/counter_rng.h"
+
+namespace ripples {
+
+//! \brief Word-at-a-time live-edge sampler for the IC model.
+//!
+//! Edge weights are quantized once to 53-bit integer thresholds.  An edge is
+//! live when the top 53 bits of splitmix64(key ^ edge_number) do not exceed
+//! its threshold: the same test as counter_uniform(key, edge_number) <=
+//! weight, so that a sample equals the ImplicitEdgeMask with the same key.
+//! The 64 draws of a word are independent of each other, so the loop
+//! building the word vectorizes, and any range of words of any sample can be
+//! produced by any thread.
+//!
+//! \tparam GraphTy The type of the input graph.
+template <typename GraphTy>
+class VectorizedICSampler {
+ public:
+  //! The number of edges sampled together.
+  static constexpr size_t word_bits = 64;
+
+  explicit VectorizedICSampler(const GraphTy &G)
+      : num_edges_(G.num_edges()),
+        num_words_((num_edges_ + word_bits - 1) / word_bits),
+        thresholds_(num_words_ * word_bits, 0) {
+    constexpr double scale = 9007199254740992.0;  // 2^53
+    const auto *edges = G.csr_edges();
+    for (size_t i = 0; i < num_edges_; ++i) {
+      double w = std::min<double>(std::max<double>(edges[i].weight, 0), 1);
+      thresholds_[i] = static_cast<uint64_t>(w * scale);
+    }
+  }
+
+  //! The number of words of a sample.
+  size_t num_words() const { return num_words_; }
+
+  //! \brief Write the words [first, last) of the sample with the given key.
+  //!
+  //! \param key The key of the sample, see world_key().
+  //! \param first The first word to write.
+  //! \param last One past the last word to write.
+  //! \param M The destination bitmask, of num_edges bits.
+  template <typename BaseTy>
+  void sample(uint64_t key, size_t first, size_t last,
+              Bitmask<BaseTy> &M) const {
+    uint64_t *words = M.words();
+    for (size_t w = first; w < last; ++w) {
+      const uint64_t base = w * word_bits;
+      const uint64_t *threshold = thresholds_.data() + base;
+      uint64_t word = 0;
+#pragma omp simd reduction(| : word)
+      for (size_t j = 0; j < word_bits; ++j) {
+        uint64_t r = splitmix64(key ^ (base + j)) >> 11;
+        word |= static_cast<uint64_t>(r <= threshold[j]) << j;
+      }
+      words[w] = word;
+    }
+    // The padding thresholds are zero, which still lets a draw of zero
+    // through: keep the bits past the last edge clear.
+    if (last == num_words_ && num_edges_ % word_bits)
+      words[last - 1] &= ~uint64_t(0) >> (word_bits - num_edges_ % word_bits);
+  }
+
+ private:
+  size_t num_edges_;
+  size_t num_words_;
+  std::vector<uint64_t> thresholds_;
+};
+
+}  // namespace ripples
+
+#endif  // RIPPLES_VECTORIZED_IC_SAMPLER_H
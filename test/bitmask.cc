@@ -0,0 +1,198 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "ripples/bitmask.h"
+#include "ripples/compressed_edge_mask.h"
+#include "trng/lcg64.hpp"
+#include "trng/uniform_int_dist.hpp"
+
+SCENARIO("Bitmask bit operations", "[bitmask]") {
+  GIVEN("A bitmask and a reference set of random positions") {
+    const size_t num_bits = 1000;
+    ripples::Bitmask<> A(num_bits);
+    std::set<size_t> reference;
+
+    trng::lcg64 generator;
+    trng::uniform_int_dist rnd_bit(0, num_bits);
+    for (size_t i = 0; i < 200; ++i) {
+      size_t b = rnd_bit(generator);
+      REQUIRE(A.test_and_set(b) == (reference.count(b) == 0));
+      reference.insert(b);
+    }
+    // The last bit of every word is where a sign-unsafe mask would break.
+    for (size_t b : {size_t(31), size_t(63), size_t(64), num_bits - 1}) {
+      A.set(b);
+      reference.insert(b);
+    }
+
+    THEN("get, popcount and iteration agree with the reference") {
+      REQUIRE(A.popcount() == reference.size());
+      for (size_t i = 0; i < num_bits; ++i)
+        REQUIRE(A.get(i) == (reference.count(i) != 0));
+
+      std::vector<size_t> visited;
+      A.for_each([&](size_t i) { visited.push_back(i); });
+      REQUIRE(visited == std::vector<size_t>(reference.begin(), reference.end()));
+
+      std::vector<size_t> found;
+      for (size_t i = A.find_first(); i < A.size(); i = A.find_next(i + 1))
+        found.push_back(i);
+      REQUIRE(found == visited);
+    }
+
+    WHEN("I unset every bit") {
+      for (size_t b : reference) A.unset(b);
+      THEN("The bitmask is empty") {
+        REQUIRE(A.none());
+        REQUIRE(A.find_first() == A.size());
+      }
+    }
+
+    WHEN("I combine it with a second bitmask") {
+      ripples::Bitmask<> B(num_bits);
+      std::set<size_t> other;
+      for (size_t i = 0; i < 300; ++i) {
+        size_t b = rnd_bit(generator);
+        B.set(b);
+        other.insert(b);
+      }
+
+      std::vector<size_t> both, either, only;
+      std::set_intersection(reference.begin(), reference.end(), other.begin(),
+                            other.end(), std::back_inserter(both));
+      std::set_union(reference.begin(), reference.end(), other.begin(),
+                     other.end(), std::back_inserter(either));
+      std::set_difference(reference.begin(), reference.end(), other.begin(),
+                          other.end(), std::back_inserter(only));
+
+      THEN("The bulk operations match the set operations") {
+        REQUIRE(A.popcount_and(B) == both.size());
+        REQUIRE(A.popcount_and_not(B) == only.size());
+
+        auto C = A;
+        C &= B;
+        REQUIRE(C.popcount() == both.size());
+        for (size_t b : both) REQUIRE(C.get(b));
+
+        C = A;
+        C |= B;
+        REQUIRE(C.popcount() == either.size());
+
+        C = A;
+        C.and_not(B);
+        REQUIRE(C.popcount() == only.size());
+        for (size_t b : only) REQUIRE(C.get(b));
+
+        C ^= A;
+        REQUIRE(C.popcount() == both.size());
+        C.and_not(B);
+        REQUIRE(C.none());
+      }
+    }
+  }
+}
+
+SCENARIO("Bitmask layout", "[bitmask]") {
+  GIVEN("A bitmask seen through 32-bit words") {
+    ripples::Bitmask<int> A(100);
+    A.set(5);
+    A.set(33);
+    A.set(95);
+
+    THEN("Bit i is bit i % 32 of the i / 32 int") {
+      REQUIRE(A.data()[0] == (1 << 5));
+      REQUIRE(A.data()[1] == (1 << 1));
+      REQUIRE(static_cast<unsigned>(A.data()[2]) == (1u << 31));
+      REQUIRE(A.bytes() >= (100 / 32 + 1) * sizeof(int));
+    }
+
+    THEN("The storage is aligned to a cache line") {
+      REQUIRE(reinterpret_cast<uintptr_t>(A.data()) %
+                  ripples::Bitmask<int>::alignment ==
+              0);
+    }
+  }
+}
+
+SCENARIO("Compressed live-edge masks", "[bitmask]") {
+  GIVEN("A sparse and a dense random sample") {
+    const size_t num_edges = 5000;
+    trng::lcg64 generator;
+    trng::uniform_int_dist rnd_edge(0, num_edges);
+
+    for (size_t live : {size_t(50), size_t(2500)}) {
+      ripples::Bitmask<int> M(num_edges);
+      for (size_t i = 0; i < live; ++i) M.set(rnd_edge(generator));
+
+      ripples::CompressedEdgeMask C(M);
+      REQUIRE(C.sparse() == (live == 50));
+      REQUIRE(C.bytes() <= M.bytes());
+
+      THEN("It has the same live edges in every range") {
+        for (size_t i = 0; i < num_edges; ++i) REQUIRE(C.get(i) == M.get(i));
+
+        for (size_t first = 0; first < num_edges; first += 97) {
+          size_t last = std::min(first + 211, num_edges);
+          std::vector<size_t> expected, found;
+          for (size_t e = first; e < last; ++e)
+            if (M.get(e)) expected.push_back(e);
+          ripples::for_each_live_edge(C, first, last,
+                                      [&](size_t e) { found.push_back(e); });
+          REQUIRE(found == expected);
+          REQUIRE(ripples::next_live_edge(C, first, last) ==
+                  (expected.empty() ? last : expected.front()));
+        }
+
+        ripples::Bitmask<int> R;
+        C.materialize(R);
+        REQUIRE(R == M);
+      }
+    }
+  }
+}
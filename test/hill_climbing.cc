@@ -0,0 +1,387 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "omp.h"
+#include "ripples/compressed_edge_mask.h"
+#include "ripples/graph.h"
+#include "ripples/hill_climbing_engine.h"
+#include "ripples/implicit_edge_mask.h"
+#include "ripples/live_edge_condensation.h"
+#include "ripples/sketch_selection_engine.h"
+#include "ripples/vectorized_ic_sampler.h"
+
+using EdgeT = ripples::Edge<uint32_t, float>;
+extern std::vector<EdgeT> karate;
+
+namespace {
+//! Select k seeds with the CPU seed selection engine.
+template <typename GraphTy, typename ItrTy>
+std::vector<typename GraphTy::vertex_type> SelectSeeds(
+    const GraphTy &G, ItrTy B, ItrTy E, size_t k,
+    const ripples::HCCountingOptions &options) {
+  std::vector<std::vector<std::chrono::duration<double, std::milli>>> record;
+  std::vector<typename GraphTy::vertex_type> seeds;
+  // The engine registers a logger under a fixed name.
+  spdlog::drop("SeedSelectionEngine");
+  {
+    ripples::SeedSelectionEngine<GraphTy, ItrTy> engine(
+        G, omp_get_max_threads(), 0, options);
+    seeds = engine.exec(B, E, k, record);
+  }
+  spdlog::drop("SeedSelectionEngine");
+  return seeds;
+}
+
+//! The vertices reached from u through the live edges of M.
+template <typename GraphTy, typename GraphMaskTy>
+std::vector<bool> Reachable(const GraphTy &G, const GraphMaskTy &M,
+                            typename GraphTy::vertex_type u) {
+  auto edges = G.neighbors(0).begin();
+  std::vector<bool> reached(G.num_nodes(), false);
+  std::vector<typename GraphTy::vertex_type> queue(1, u);
+  reached[u] = true;
+  for (size_t head = 0; head < queue.size(); ++head) {
+    auto v = queue[head];
+    for (auto itr = G.neighbors(v).begin(); itr != G.neighbors(v).end();
+         ++itr) {
+      if (!M.get(std::distance(edges, itr)) || reached[itr->vertex]) continue;
+      reached[itr->vertex] = true;
+      queue.push_back(itr->vertex);
+    }
+  }
+  return reached;
+}
+}  // namespace
+
+SCENARIO("Hill climbing counting modes", "[hill_climbing]") {
+  GIVEN("The Karate Graph and 500 IC samples") {
+    using destination_type = ripples::WeightedDestination<uint32_t, float>;
+    using GraphFwd = ripples::Graph<uint32_t, destination_type,
+                                    ripples::ForwardDirection<uint32_t>>;
+
+    GraphFwd G(karate.begin(), karate.end(), true);
+    std::vector<ripples::Bitmask<int>> samples(
+        500, ripples::Bitmask<int>(G.num_edges()));
+    ripples::VectorizedICSampler<GraphFwd> sampler(G);
+    for (size_t s = 0; s < samples.size(); ++s)
+      sampler.sample(ripples::world_key(0, s), 0, sampler.num_words(),
+                     samples[s]);
+
+    const size_t k = 8;
+    ripples::HCCountingOptions options;
+    auto seeds = SelectSeeds(G, samples.begin(), samples.end(), k, options);
+    REQUIRE(seeds.size() == k);
+
+    WHEN("The gains are evaluated lazily") {
+      options.lazy = true;
+      auto lazy_seeds =
+          SelectSeeds(G, samples.begin(), samples.end(), k, options);
+
+      THEN("The seeds are those of the full scan") {
+        REQUIRE(lazy_seeds == seeds);
+      }
+    }
+
+    WHEN("The gains are counted over the SCC condensations") {
+      options.scc_counting = true;
+      auto scc_seeds =
+          SelectSeeds(G, samples.begin(), samples.end(), k, options);
+
+      THEN("The seeds are those of the per-vertex traversals") {
+        REQUIRE(scc_seeds == seeds);
+      }
+    }
+
+    WHEN("The frontiers of the seed set are not cached") {
+      options.frontier_cache = false;
+      auto sample_seeds =
+          SelectSeeds(G, samples.begin(), samples.end(), k, options);
+      options.parallelism = "vertices";
+      auto vertex_seeds =
+          SelectSeeds(G, samples.begin(), samples.end(), k, options);
+
+      THEN("The seeds are those of the cached frontiers") {
+        REQUIRE(sample_seeds == seeds);
+        REQUIRE(vertex_seeds == seeds);
+      }
+    }
+
+    WHEN("More seeds than vertices are asked for") {
+      options.lazy = true;
+      auto lazy_seeds = SelectSeeds(G, samples.begin(), samples.end(),
+                                    G.num_nodes() + 2, options);
+
+      THEN("Every vertex is selected once") {
+        REQUIRE(lazy_seeds.size() == G.num_nodes());
+        std::sort(lazy_seeds.begin(), lazy_seeds.end());
+        for (size_t v = 0; v < G.num_nodes(); ++v)
+          REQUIRE(lazy_seeds[v] == v);
+      }
+    }
+  }
+}
+
+SCENARIO("Vertex-parallel hill climbing counting", "[hill_climbing]") {
+  GIVEN("The Karate Graph and 500 IC samples") {
+    using destination_type = ripples::WeightedDestination<uint32_t, float>;
+    using GraphFwd = ripples::Graph<uint32_t, destination_type,
+                                    ripples::ForwardDirection<uint32_t>>;
+
+    GraphFwd G(karate.begin(), karate.end(), true);
+    std::vector<ripples::Bitmask<int>> samples(
+        500, ripples::Bitmask<int>(G.num_edges()));
+    ripples::VectorizedICSampler<GraphFwd> sampler(G);
+    for (size_t s = 0; s < samples.size(); ++s)
+      sampler.sample(ripples::world_key(0, s), 0, sampler.num_words(),
+                     samples[s]);
+
+    const size_t k = 8;
+    ripples::HCCountingOptions samples_options, vertices_options;
+    samples_options.parallelism = "samples";
+    vertices_options.parallelism = "vertices";
+
+    WHEN("Every vertex is counted at every step") {
+      auto seeds =
+          SelectSeeds(G, samples.begin(), samples.end(), k, samples_options);
+      auto vertex_seeds =
+          SelectSeeds(G, samples.begin(), samples.end(), k, vertices_options);
+
+      THEN("The seeds are those of the sample-parallel pass") {
+        REQUIRE(vertex_seeds == seeds);
+      }
+    }
+
+    WHEN("Only the lazy candidates are counted") {
+      samples_options.lazy = vertices_options.lazy = true;
+      auto seeds =
+          SelectSeeds(G, samples.begin(), samples.end(), k, samples_options);
+      auto vertex_seeds =
+          SelectSeeds(G, samples.begin(), samples.end(), k, vertices_options);
+
+      THEN("The seeds are those of the sample-parallel pass") {
+        REQUIRE(vertex_seeds == seeds);
+      }
+    }
+
+    WHEN("There are fewer samples than workers") {
+      ripples::HCCountingOptions auto_options;
+      auto seeds = SelectSeeds(G, samples.begin(), samples.begin() + 1, k,
+                               samples_options);
+      auto auto_seeds = SelectSeeds(G, samples.begin(), samples.begin() + 1,
+                                    k, auto_options);
+
+      THEN("The automatic choice finds the same seeds") {
+        REQUIRE(auto_seeds == seeds);
+      }
+    }
+  }
+}
+
+SCENARIO("Implicit hill climbing samples", "[hill_climbing]") {
+  GIVEN("The Karate Graph and 500 IC samples stored as bitmasks") {
+    using destination_type = ripples::WeightedDestination<uint32_t, float>;
+    using GraphFwd = ripples::Graph<uint32_t, destination_type,
+                                    ripples::ForwardDirection<uint32_t>>;
+
+    GraphFwd G(karate.begin(), karate.end(), true);
+    std::vector<ripples::Bitmask<int>> samples(
+        500, ripples::Bitmask<int>(G.num_edges()));
+    ripples::VectorizedICSampler<GraphFwd> sampler(G);
+    for (size_t s = 0; s < samples.size(); ++s)
+      sampler.sample(ripples::world_key(0, s), 0, sampler.num_words(),
+                     samples[s]);
+
+    WHEN("Implicit samples are defined by the same key") {
+      ripples::ImplicitSampleSpace<GraphFwd> space(
+          G, 0, ripples::independent_cascade_tag{});
+      auto implicit = space.samples(samples.size());
+
+      THEN("They have the same live edges") {
+        ripples::Bitmask<int> M(G.num_edges());
+        for (size_t s = 0; s < samples.size(); ++s) {
+          implicit[s].materialize(M);
+          REQUIRE(M == samples[s]);
+        }
+      }
+
+      THEN("They select the same seeds") {
+        const size_t k = 8;
+        ripples::HCCountingOptions options;
+        options.frontier_cache = false;
+        auto seeds =
+            SelectSeeds(G, samples.begin(), samples.end(), k, options);
+        auto implicit_seeds =
+            SelectSeeds(G, implicit.begin(), implicit.end(), k, options);
+        REQUIRE(implicit_seeds == seeds);
+      }
+    }
+  }
+}
+
+SCENARIO("Compressed hill climbing samples", "[hill_climbing]") {
+  GIVEN("The Karate Graph and 500 IC samples stored as bitmasks") {
+    using destination_type = ripples::WeightedDestination<uint32_t, float>;
+    using GraphFwd = ripples::Graph<uint32_t, destination_type,
+                                    ripples::ForwardDirection<uint32_t>>;
+    using dense_iterator = std::vector<ripples::Bitmask<int>>::iterator;
+    using compressed_iterator =
+        std::vector<ripples::CompressedEdgeMask>::iterator;
+
+    GraphFwd G(karate.begin(), karate.end(), true);
+    std::vector<ripples::Bitmask<int>> samples(
+        500, ripples::Bitmask<int>(G.num_edges()));
+    ripples::VectorizedICSampler<GraphFwd> sampler(G);
+    for (size_t s = 0; s < samples.size(); ++s)
+      sampler.sample(ripples::world_key(0, s), 0, sampler.num_words(),
+                     samples[s]);
+
+    WHEN("The samples are compressed") {
+      std::vector<ripples::CompressedEdgeMask> compressed;
+      for (auto &M : samples) compressed.emplace_back(M);
+      const size_t k = 8;
+
+      THEN("The counting modes select the seeds of the bitmasks") {
+        ripples::HCCountingOptions options;
+        options.frontier_cache = false;
+        for (bool scc : {false, true}) {
+          options.scc_counting = scc;
+          auto seeds =
+              SelectSeeds(G, samples.begin(), samples.end(), k, options);
+          auto compressed_seeds = SelectSeeds(G, compressed.begin(),
+                                              compressed.end(), k, options);
+          REQUIRE(compressed_seeds == seeds);
+        }
+      }
+
+      THEN("Their condensations are those of the bitmasks") {
+        for (size_t s = 0; s < 20; ++s) {
+          auto C = ripples::CondenseLiveEdgeGraph(G, samples[s]);
+          auto CC = ripples::CondenseLiveEdgeGraph(G, compressed[s]);
+          REQUIRE(CC.component == C.component);
+          REQUIRE(CC.dag_index == C.dag_index);
+          REQUIRE(CC.dag_edges == C.dag_edges);
+        }
+      }
+
+      THEN("The sketch selection finds the seeds of the bitmasks") {
+        std::vector<std::vector<std::chrono::duration<double, std::milli>>>
+            record;
+        std::vector<uint32_t> seeds;
+        std::vector<double> gains;
+        {
+          // The engines register a logger under a fixed name.
+          ripples::SketchSeedSelectionEngine<GraphFwd, dense_iterator> dense(
+              G, 64, 1);
+          seeds = dense.exec(samples.begin(), samples.end(), k, record);
+          gains = dense.estimated_gains();
+        }
+        ripples::SketchSeedSelectionEngine<GraphFwd, compressed_iterator>
+            sketch(G, 64, 1);
+        auto compressed_seeds =
+            sketch.exec(compressed.begin(), compressed.end(), k, record);
+        REQUIRE(compressed_seeds == seeds);
+        REQUIRE(sketch.estimated_gains() == gains);
+      }
+    }
+  }
+}
+
+SCENARIO("Condensation of live-edge graphs", "[hill_climbing]") {
+  GIVEN("The Karate Graph and 20 IC samples") {
+    using destination_type = ripples::WeightedDestination<uint32_t, float>;
+    using GraphFwd = ripples::Graph<uint32_t, destination_type,
+                                    ripples::ForwardDirection<uint32_t>>;
+    using vertex_type = typename GraphFwd::vertex_type;
+
+    GraphFwd G(karate.begin(), karate.end(), true);
+    ripples::VectorizedICSampler<GraphFwd> sampler(G);
+    ripples::Bitmask<int> sample(G.num_edges());
+    auto edges = G.neighbors(0).begin();
+
+    for (size_t s = 0; s < 20; ++s) {
+      sampler.sample(ripples::world_key(0, s), 0, sampler.num_words(),
+                     sample);
+      auto C = ripples::CondenseLiveEdgeGraph(G, sample);
+      std::vector<std::vector<bool>> reached;
+      for (vertex_type v = 0; v < G.num_nodes(); ++v)
+        reached.push_back(Reachable(G, sample, v));
+
+      // Two vertices share a component iff they reach each other.
+      for (vertex_type u = 0; u < G.num_nodes(); ++u)
+        for (vertex_type v = 0; v < G.num_nodes(); ++v)
+          REQUIRE((C.component[u] == C.component[v]) ==
+                  (reached[u][v] && reached[v][u]));
+
+      // Members and sizes agree with the component of every vertex.
+      for (size_t c = 0; c < C.size.size(); ++c) {
+        REQUIRE(C.members_index[c + 1] - C.members_index[c] == C.size[c]);
+        for (size_t i = C.members_index[c]; i < C.members_index[c + 1]; ++i)
+          REQUIRE(C.component[C.members[i]] == c);
+      }
+
+      // The DAG has one edge per pair of components joined by a live edge,
+      // toward the smaller index.
+      for (size_t c = 0; c < C.size.size(); ++c) {
+        std::vector<uint32_t> out(C.dag_edges.begin() + C.dag_index[c],
+                                  C.dag_edges.begin() + C.dag_index[c + 1]);
+        std::vector<uint32_t> expected;
+        for (size_t i = C.members_index[c]; i < C.members_index[c + 1]; ++i)
+          for (auto itr = G.neighbors(C.members[i]).begin();
+               itr != G.neighbors(C.members[i]).end(); ++itr)
+            if (sample.get(std::distance(edges, itr)) &&
+                C.component[itr->vertex] != c)
+              expected.push_back(C.component[itr->vertex]);
+        for (auto d : out) REQUIRE(d < c);
+        std::sort(out.begin(), out.end());
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::unique(expected.begin(), expected.end()),
+                       expected.end());
+        REQUIRE(out == expected);
+      }
+    }
+  }
+}
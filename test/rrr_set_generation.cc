@@ -40,6 +40,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
 #include "catch2/catch.hpp"
 
 #include "ripples/generate_rrr_sets.h"
@@ -67,6 +74,37 @@ std::vector<EdgeT> karate{
     {29, 34, 0.5}, {30, 33, 0.5}, {30, 34, 0.5}, {31, 33, 0.5}, {31, 34, 0.5},
     {32, 33, 0.5}, {32, 34, 0.5}, {33, 34, 0.5}};
 
+namespace {
+//! The temporary directory, from TMPDIR when set.
+std::string TemporaryPrefix() {
+  const char *tmpdir = std::getenv("TMPDIR");
+  return std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/ripples-test-";
+}
+
+//! A uniquely named file, removed when going out of scope.
+struct TemporaryFile {
+  std::string path;
+
+  TemporaryFile() : path(TemporaryPrefix() + "XXXXXX") {
+    int fd = mkstemp(&path[0]);
+    if (fd == -1) throw std::runtime_error("Unable to create " + path);
+    close(fd);
+  }
+  ~TemporaryFile() { unlink(path.c_str()); }
+};
+
+//! A uniquely named directory, removed when going out of scope.
+struct TemporaryDirectory {
+  std::string path;
+
+  TemporaryDirectory() : path(TemporaryPrefix() + "XXXXXX") {
+    if (mkdtemp(&path[0]) == nullptr)
+      throw std::runtime_error("Unable to create " + path);
+  }
+  ~TemporaryDirectory() { rmdir(path.c_str()); }
+};
+}  // namespace
+
 SCENARIO("Generate RRR sets", "[rrrsets]") {
   GIVEN("The Karate Graph") {
     using destination_type = ripples::WeightedDestination<uint32_t, float>;
@@ -141,5 +179,141 @@ SCENARIO("Generate RRR sets", "[rrrsets]") {
         RR.insert(RR.end(), theta, ripples::RRRset<GraphBwd>{});
       }
     }
+
+    WHEN("I build the RRR sets deterministically with different workers") {
+      size_t theta = 100;
+      size_t max_num_threads(1);
+#pragma omp single
+      max_num_threads = omp_get_max_threads();
+
+      trng::lcg64 gen;
+      ripples::IMMExecutionRecord R;
+      decltype(ripples::IMMConfiguration::worker_to_gpu) map;
+
+      using generator_type = ripples::StreamingRRRGenerator<
+          decltype(G), decltype(gen),
+          typename ripples::RRRsets<decltype(G)>::iterator,
+          ripples::independent_cascade_tag>;
+      generator_type one(G, gen, R, 1, 0, map);
+      generator_type many(G, gen, R, max_num_threads, 0, map);
+      generator_type numa(G, gen, R, max_num_threads, 0, map);
+      one.enable_deterministic_sampling();
+      many.enable_deterministic_sampling();
+      numa.enable_deterministic_sampling();
+      numa.enable_numa(2, true);
+      many.enable_fused_counting();
+
+      std::vector<ripples::RRRset<GraphBwd>> RROne(2 * theta);
+      std::vector<ripples::RRRset<GraphBwd>> RRMany(2 * theta);
+      std::vector<ripples::RRRset<GraphBwd>> RRNuma(2 * theta);
+      one.generate(RROne.begin(), RROne.end());
+      many.generate(RRMany.begin(), RRMany.begin() + theta);
+      many.generate(RRMany.begin() + theta, RRMany.end());
+      numa.generate(RRNuma.begin(), RRNuma.begin() + theta);
+      numa.generate(RRNuma.begin() + theta, RRNuma.end());
+
+      THEN("They produce the same RRR sets.") {
+        REQUIRE(one.num_generated() == many.num_generated());
+        for (size_t i = 0; i < RROne.size(); ++i) {
+          REQUIRE(RROne[i] == RRMany[i]);
+          REQUIRE(RROne[i] == RRNuma[i]);
+        }
+      }
+
+      THEN("The fused counters match the occurrencies in the RRR sets.") {
+        std::vector<uint32_t> counts(G.num_nodes(), 0);
+        ripples::CountOccurrencies(RRMany.begin(), RRMany.end(),
+                                   counts.begin(), counts.end(),
+                                   ripples::sequential_tag{});
+        REQUIRE(many.coverage() != nullptr);
+        REQUIRE(*many.coverage() == counts);
+      }
+
+      THEN("NUMA counting covers every RRR set with a smaller team.") {
+        std::vector<uint32_t> counts(G.num_nodes(), 0);
+        ripples::CountOccurrencies(RRMany.begin(), RRMany.end(),
+                                   counts.begin(), counts.end(),
+                                   ripples::sequential_tag{});
+        // Without nesting, the inner team has a single thread.
+        std::vector<uint32_t> numa_counts(G.num_nodes(), 0);
+        omp_set_max_active_levels(1);
+#pragma omp parallel num_threads(2)
+#pragma omp single
+        ripples::CountOccurrencies(RRMany.begin(), RRMany.end(),
+                                   numa_counts.begin(), numa_counts.end(),
+                                   4, 4);
+        REQUIRE(numa_counts == counts);
+      }
+
+      THEN("Incremental selection does not depend on the absorbed rounds.") {
+        std::vector<ripples::RRRset<GraphBwd>> RRPrefix(
+            RROne.begin(), RROne.begin() + theta);
+        ripples::IncrementalFindMostInfluential<GraphBwd> twoRounds(
+            G, max_num_threads);
+        twoRounds.find_most_influential_set(RRPrefix, 5);
+        RRPrefix.insert(RRPrefix.end(), RROne.begin() + theta, RROne.end());
+        auto S = twoRounds.find_most_influential_set(RRPrefix, 5);
+
+        ripples::IncrementalFindMostInfluential<GraphBwd> oneRound(G, 1);
+        REQUIRE(oneRound.find_most_influential_set(RROne, 5) == S);
+
+        size_t covered = 0;
+        for (auto& set : RROne)
+          covered += std::any_of(S.second.begin(), S.second.end(),
+                                 [&](uint32_t v) {
+                                   return std::binary_search(set.begin(),
+                                                             set.end(), v);
+                                 });
+        REQUIRE(S.first == double(covered) / RROne.size());
+        REQUIRE(ripples::PrefixCoverage(G, RROne, S.second, max_num_threads)
+                    .back() == S.first);
+      }
+
+      THEN("Spilling RRR sets to disk does not change the selection.") {
+        // Declared first: the store removes its chunks before the directory
+        // is removed.
+        TemporaryDirectory directory;
+        ripples::RRRSpillStore<GraphBwd> store(G, directory.path, 1,
+                                               max_num_threads);
+        std::vector<ripples::RRRset<GraphBwd>> RRMemory(
+            RROne.begin(), RROne.begin() + theta / 2);
+        REQUIRE(store.over_budget(RRMemory));
+        store.spill(RRMemory);
+        RRMemory.assign(RROne.begin() + theta / 2, RROne.begin() + theta);
+        store.spill(RRMemory);
+        RRMemory.assign(RROne.begin() + theta, RROne.end());
+
+        REQUIRE(store.num_chunks() == 2);
+        REQUIRE(store.num_sets() == theta);
+
+        ripples::IncrementalFindMostInfluential<GraphBwd> inMemory(G, 1);
+        auto S = inMemory.find_most_influential_set(RROne, 5);
+        REQUIRE(store.find_most_influential_set(RRMemory, 5) == S);
+        REQUIRE(store.prefix_coverage(RRMemory, S.second) ==
+                ripples::PrefixCoverage(G, RROne, S.second, 1));
+      }
+
+      THEN("Saved RRR sets are reloaded and sampling continues after them.") {
+        TemporaryFile file;
+        const std::string &path = file.path;
+        std::vector<ripples::RRRset<GraphBwd>> RRPrefix(
+            RROne.begin(), RROne.begin() + theta);
+        ripples::SaveRRRSets(path, G, "IC", 0, RRPrefix);
+
+        auto RRLoaded = ripples::LoadRRRSets(path, G, "IC", 0);
+        REQUIRE(RRLoaded == RRPrefix);
+        REQUIRE(ripples::LoadRRRSetsSeed(path) == 0);
+        REQUIRE_THROWS(ripples::LoadRRRSets(path, G, "LT", 0));
+        REQUIRE_THROWS(ripples::LoadRRRSets(path, G, "IC", 1));
+        REQUIRE_THROWS(ripples::LoadRRRSets(path, Gfwd, "IC", 0));
+
+        generator_type resumed(G, gen, R, max_num_threads, 0, map);
+        resumed.enable_deterministic_sampling();
+        resumed.skip(RRLoaded.size());
+        RRLoaded.resize(2 * theta);
+        resumed.generate(RRLoaded.begin() + theta, RRLoaded.end());
+        REQUIRE(RRLoaded == RROne);
+      }
+    }
   }
 }
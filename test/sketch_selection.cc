@@ -0,0 +1,144 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "omp.h"
+#include "ripples/graph.h"
+#include "ripples/hill_climbing_engine.h"
+#include "ripples/sketch_selection_engine.h"
+#include "ripples/vectorized_ic_sampler.h"
+
+using EdgeT = ripples::Edge<uint32_t, float>;
+extern std::vector<EdgeT> karate;
+
+namespace {
+//! The average number of vertices reached by S over the samples.
+template <typename GraphTy, typename SeedSet>
+double spread(const GraphTy &G, const std::vector<ripples::Bitmask<int>> &M,
+              const SeedSet &S) {
+  using vertex_type = typename GraphTy::vertex_type;
+  auto edges = G.neighbors(0).begin();
+  size_t total = 0;
+  for (auto &sample : M) {
+    ripples::Bitmask<int> visited(G.num_nodes());
+    std::vector<vertex_type> queue;
+    for (auto s : S)
+      if (visited.test_and_set(s)) queue.push_back(s);
+    for (size_t head = 0; head < queue.size(); ++head) {
+      vertex_type u = queue[head];
+      ripples::for_each_live_edge(
+          sample, std::distance(edges, G.neighbors(u).begin()),
+          std::distance(edges, G.neighbors(u).end()), [&](size_t e) {
+            if (visited.test_and_set(edges[e].vertex))
+              queue.push_back(edges[e].vertex);
+          });
+    }
+    total += queue.size();
+  }
+  return double(total) / M.size();
+}
+}  // namespace
+
+SCENARIO("Sketch-based hill climbing", "[hill_climbing]") {
+  GIVEN("The Karate Graph and 500 IC samples") {
+    using destination_type = ripples::WeightedDestination<uint32_t, float>;
+    using GraphFwd = ripples::Graph<uint32_t, destination_type,
+                                    ripples::ForwardDirection<uint32_t>>;
+    using vertex_type = typename GraphFwd::vertex_type;
+    using iterator = std::vector<ripples::Bitmask<int>>::iterator;
+
+    GraphFwd G(karate.begin(), karate.end(), true);
+    std::vector<ripples::Bitmask<int>> samples(
+        500, ripples::Bitmask<int>(G.num_edges()));
+    ripples::VectorizedICSampler<GraphFwd> sampler(G);
+    for (size_t s = 0; s < samples.size(); ++s)
+      sampler.sample(ripples::world_key(0, s), 0, sampler.num_words(),
+                     samples[s]);
+
+    const size_t k = 4;
+    std::vector<std::vector<std::chrono::duration<double, std::milli>>> record;
+
+    WHEN("The sketches can hold every pair") {
+      ripples::SketchSeedSelectionEngine<GraphFwd, iterator> sketch(
+          G, G.num_nodes() * samples.size() + 1, 1);
+      auto seeds = sketch.exec(samples.begin(), samples.end(), k, record);
+
+      THEN("Every seed has the largest exact marginal gain") {
+        std::vector<vertex_type> S;
+        for (size_t i = 0; i < k; ++i) {
+          double base = spread(G, samples, S);
+          double best = 0;
+          for (vertex_type v = 0; v < G.num_nodes(); ++v) {
+            if (std::find(S.begin(), S.end(), v) != S.end()) continue;
+            S.push_back(v);
+            best = std::max(best, spread(G, samples, S) - base);
+            S.pop_back();
+          }
+          S.push_back(seeds[i]);
+          double gain = spread(G, samples, S) - base;
+          REQUIRE(gain == Approx(best));
+          REQUIRE(sketch.estimated_gains()[i] == Approx(gain));
+        }
+      }
+    }
+
+    WHEN("The sketches hold 64 pairs") {
+      ripples::SketchSeedSelectionEngine<GraphFwd, iterator> sketch(G, 64, 1);
+      auto seeds = sketch.exec(samples.begin(), samples.end(), k, record);
+
+      ripples::SeedSelectionEngine<GraphFwd, iterator> exact(
+          G, omp_get_max_threads(), 0);
+      auto exact_seeds = exact.exec(samples.begin(), samples.end(), k, record);
+
+      THEN("The spread is close to the exact selection") {
+        REQUIRE(seeds.size() == k);
+        REQUIRE(spread(G, samples, seeds) >=
+                0.9 * spread(G, samples, exact_seeds));
+      }
+    }
+  }
+}
@@ -0,0 +1,167 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "ripples/bitmask.h"
+
+#include "CLI/CLI.hpp"
+#include "spdlog/sinks/stdout_color_sinks.h"
+#include "spdlog/spdlog.h"
+#include "trng/lcg64.hpp"
+#include "trng/uniform01_dist.hpp"
+
+namespace {
+
+//! The bit-at-a-time baseline the word operations are measured against.
+template <typename BaseTy>
+size_t scalar_popcount(const ripples::Bitmask<BaseTy> &A) {
+  size_t count = 0;
+  for (size_t i = 0; i < A.size(); ++i) count += A.get(i);
+  return count;
+}
+
+template <typename BaseTy>
+size_t scalar_popcount_and(const ripples::Bitmask<BaseTy> &A,
+                           const ripples::Bitmask<BaseTy> &B) {
+  size_t count = 0;
+  for (size_t i = 0; i < A.size(); ++i) count += A.get(i) && B.get(i);
+  return count;
+}
+
+template <typename BaseTy>
+void scalar_or(ripples::Bitmask<BaseTy> &A, const ripples::Bitmask<BaseTy> &B) {
+  for (size_t i = 0; i < A.size(); ++i)
+    if (B.get(i)) A.set(i);
+}
+
+template <typename BaseTy>
+size_t scalar_scan(const ripples::Bitmask<BaseTy> &A) {
+  size_t sum = 0;
+  for (size_t i = 0; i < A.size(); ++i)
+    if (A.get(i)) sum += i;
+  return sum;
+}
+
+//! Time f over the given number of repetitions.
+//! \return The average time per repetition in microseconds.
+template <typename Function>
+double measure(size_t repetitions, Function &&f) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t r = 0; r < repetitions; ++r) f();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         repetitions;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t num_bits = 1 << 24;
+  double density = 0.1;
+  size_t repetitions = 10;
+
+  CLI::App app;
+  app.add_option("--bits", num_bits, "The number of bits in each mask.")
+      ->group("Benchmark Options");
+  app.add_option("--density", density, "The fraction of bits set.")
+      ->group("Benchmark Options");
+  app.add_option("--repetitions", repetitions,
+                 "The number of timed repetitions of each operation.")
+      ->group("Benchmark Options");
+  try {
+    app.parse(argc, argv);
+  } catch (const CLI::ParseError &e) {
+    return app.exit(e);
+  }
+
+  auto console = spdlog::stdout_color_st("console");
+
+  trng::lcg64 generator;
+  trng::uniform01_dist<float> value;
+  ripples::Bitmask<> A(num_bits), B(num_bits);
+  for (size_t i = 0; i < num_bits; ++i) {
+    if (value(generator) < density) A.set(i);
+    if (value(generator) < density) B.set(i);
+  }
+  console->info("Bits : {}, Density : {}, Set : {} and {}", num_bits, density,
+                A.popcount(), B.popcount());
+
+  // Accumulate every result so that no operation is optimized away.
+  volatile size_t sink = 0;
+  auto report = [&](const char *name, double scalar, double word) {
+    console->info("{:<14} scalar {:>10.1f}us  word {:>10.1f}us  speedup {:.1f}x",
+                  name, scalar, word, scalar / word);
+  };
+
+  report("popcount",
+         measure(repetitions, [&]() { sink += scalar_popcount(A); }),
+         measure(repetitions, [&]() { sink += A.popcount(); }));
+  report("popcount_and",
+         measure(repetitions, [&]() { sink += scalar_popcount_and(A, B); }),
+         measure(repetitions, [&]() { sink += A.popcount_and(B); }));
+
+  ripples::Bitmask<> C(num_bits);
+  report("or",
+         measure(repetitions, [&]() { C = A; scalar_or(C, B); }),
+         measure(repetitions, [&]() { C = A; C |= B; }));
+
+  report("iterate",
+         measure(repetitions, [&]() { sink += scalar_scan(A); }),
+         measure(repetitions, [&]() {
+           size_t sum = 0;
+           A.for_each([&](size_t i) { sum += i; });
+           sink += sum;
+         }));
+  report("find_next",
+         measure(repetitions, [&]() { sink += scalar_scan(A); }),
+         measure(repetitions, [&]() {
+           size_t sum = 0;
+           for (size_t i = A.find_first(); i < A.size(); i = A.find_next(i + 1))
+             sum += i;
+           sink += sum;
+         }));
+
+  return EXIT_SUCCESS;
+}
@@ -73,6 +73,17 @@ auto GetExperimentRecord(
                             {"NumThreads", R.NumThreads},
                             {"NumWalkWorkers", CFG.streaming_workers},
                             {"NumGPUWalkWorkers", CFG.streaming_gpu_workers},
+                            {"SCCCounting", CFG.scc_counting},
+                            {"ImplicitSamples", CFG.implicit_samples},
+                            {"VectorizedSampling", CFG.vectorized_sampling},
+                            {"CompressedSamples", CFG.compressed_samples},
+                            {"SampleBytes", R.SampleBytes},
+                            {"Lazy", CFG.lazy},
+                            {"CountingParallelism", CFG.counting_parallelism},
+                            {"SketchSelection", CFG.sketch_selection},
+                            {"SketchSize", CFG.sketch_size},
+                            {"EstimatedGains", R.EstimatedGains},
+                            {"CandidatesPerStep", R.CandidatesPerStep},
                             {"Total", R.Total},
                             {"Sampling", R.Sampling},
                             {"SeedSelection", R.SeedSelection},
@@ -94,6 +105,10 @@ int main(int argc, char** argv) {
   spdlog::set_level(spdlog::level::trace);
 
   ripples::parse_command_line(argc, argv);
+  if (ripples::configuration().vectorized_sampling &&
+      ripples::configuration().diffusionModel != "IC")
+    console->warn("--vectorized-sampling only supports IC: using the default "
+                  "sampler");
 
   trng::lcg64 weightGen;
   weightGen.seed(0UL);
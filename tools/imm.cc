@@ -40,6 +40,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -97,6 +98,14 @@ auto GetExperimentRecord(const ToolConfiguration<IMMConfiguration> &CFG,
       {"NumThreads", R.NumThreads},
       {"NumWalkWorkers", CFG.streaming_workers},
       {"NumGPUWalkWorkers", CFG.streaming_gpu_workers},
+      {"DeterministicSampling", CFG.deterministic_sampling},
+      {"NUMADomains", CFG.numa_domains},
+      {"FusedCounting", CFG.fused_counting},
+      {"IncrementalSelection", CFG.incremental_selection},
+      {"MemoryBudget", CFG.memory_budget},
+      {"LoadRRRSets", CFG.load_rrr_sets},
+      {"SaveRRRSets", CFG.save_rrr_sets},
+      {"RNGSeed", CFG.rng_seed},
       {"Total", R.Total},
       {"ThetaPrimeDeltas", R.ThetaPrimeDeltas},
       {"ThetaEstimation", R.ThetaEstimationTotal},
@@ -108,10 +117,19 @@ auto GetExperimentRecord(const ToolConfiguration<IMMConfiguration> &CFG,
       {"RRRSetSizeBytes", R.RRRSetSize},
       {"GenerateRRRSets", R.GenerateRRRSets},
       {"FindMostInfluentialSet", R.FindMostInfluentialSet},
+      {"WalkWorkersIdle", R.WalkWorkersIdle},
       {"Seeds", seeds}};
   for (auto &ri : R.WalkIterations) {
     experiment["Iterations"].push_back(GetWalkIterationRecord(ri));
   }
+  for (size_t i = 0; i < CFG.seed_set_sizes.size(); ++i) {
+    size_t k = std::min(CFG.seed_set_sizes[i], seeds.size());
+    experiment["SeedSets"].push_back(
+        {{"K", CFG.seed_set_sizes[i]},
+         {"Theta", R.SeedSetSizesTheta[i]},
+         {"Coverage", k != 0 ? R.PrefixCoverage[k - 1] : 0.0},
+         {"Seeds", SeedSet(seeds.begin(), seeds.begin() + k)}});
+  }
   return experiment;
 }
 
@@ -126,6 +144,13 @@ void parse_command_line(int argc, char **argv) {
     CFG.seed_select_max_workers = CFG.streaming_workers;
   if (CFG.seed_select_max_gpu_workers == std::numeric_limits<size_t>::max())
     CFG.seed_select_max_gpu_workers = CFG.streaming_gpu_workers;
+
+  // Seed sets of all the requested sizes are prefixes of the largest one.
+  auto &sizes = CFG.seed_set_sizes;
+  sizes.erase(std::remove(sizes.begin(), sizes.end(), 0), sizes.end());
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+  if (!sizes.empty()) CFG.k = sizes.back();
 }
 
 ToolConfiguration<ripples::IMMConfiguration> configuration() { return CFG; }
@@ -145,6 +170,46 @@ int main(int argc, char **argv) {
       console->error("invalid command line");
       return -1;
     }
+    if (CFG.deterministic_sampling && CFG.streaming_gpu_workers != 0) {
+      console->error("deterministic sampling requires CPU-only walk workers");
+      return -1;
+    }
+    if (CFG.numa_domains > 1 && CFG.streaming_gpu_workers != 0) {
+      console->error("NUMA mode requires CPU-only walk workers");
+      return -1;
+    }
+    if (CFG.fused_counting && CFG.streaming_gpu_workers != 0) {
+      console->error("fused counting requires CPU-only walk workers");
+      return -1;
+    }
+    if (CFG.memory_budget != 0 && CFG.incremental_selection)
+      console->warn("--incremental-selection is ignored when spilling");
+    if (!CFG.save_rrr_sets.empty() || !CFG.load_rrr_sets.empty()) {
+      // Reused RRR sets are the prefix of a global sequence that the
+      // generator must continue: this needs deterministic sampling.
+      if (CFG.streaming_gpu_workers != 0) {
+        console->error("saving or loading RRR sets requires CPU-only walk "
+                       "workers");
+        return -1;
+      }
+      CFG.deterministic_sampling = true;
+    }
+    if (!CFG.save_rrr_sets.empty() && CFG.memory_budget != 0) {
+      console->error("saving RRR sets is not supported when spilling");
+      return -1;
+    }
+    if (!CFG.load_rrr_sets.empty() && CFG.fused_counting) {
+      console->warn("--fused-counting is ignored when loading RRR sets");
+      CFG.fused_counting = false;
+    }
+#ifdef ENABLE_METALL
+    ripples::metall_directory() = CFG.spill_directory + "/ripples";
+#endif
+  }
+
+  if (!CFG.parallel && !CFG.seed_set_sizes.empty()) {
+    console->error("--seed-set-sizes requires the parallel implementation");
+    return -1;
   }
 
   spdlog::set_level(spdlog::level::info);
@@ -171,7 +236,7 @@ int main(int argc, char **argv) {
   ripples::IMMExecutionRecord R;
 
   trng::lcg64 generator;
-  generator.seed(0UL);
+  generator.seed(CFG.rng_seed);
   generator.split(2, 1);
 
   std::ofstream perf(CFG.OutputFile);
@@ -187,6 +252,10 @@ int main(int argc, char **argv) {
           ripples::independent_cascade_tag>
           se(G, generator, R, workers - gpu_workers, gpu_workers,
              CFG.worker_to_gpu);
+      if (CFG.deterministic_sampling) se.enable_deterministic_sampling();
+      if (CFG.numa_domains > 1)
+        se.enable_numa(CFG.numa_domains, CFG.numa_graph_replicas);
+      if (CFG.fused_counting) se.enable_fused_counting();
       auto start = std::chrono::high_resolution_clock::now();
       seeds = IMM(G, CFG, 1, se, ripples::independent_cascade_tag{},
                   ripples::omp_parallel_tag{});
@@ -200,6 +269,10 @@ int main(int argc, char **argv) {
           ripples::linear_threshold_tag>
           se(G, generator, R, workers - gpu_workers, gpu_workers,
              CFG.worker_to_gpu);
+      if (CFG.deterministic_sampling) se.enable_deterministic_sampling();
+      if (CFG.numa_domains > 1)
+        se.enable_numa(CFG.numa_domains, CFG.numa_graph_replicas);
+      if (CFG.fused_counting) se.enable_fused_counting();
       auto start = std::chrono::high_resolution_clock::now();
       seeds = IMM(G, CFG, 1, se, ripples::linear_threshold_tag{},
                   ripples::omp_parallel_tag{});
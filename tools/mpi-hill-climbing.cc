@@ -89,7 +89,10 @@ auto GetExperimentRecord(
                             {"SamplingTasks", R.SamplingTasks},
                             {"BuildFrontiersTasks", R.BuildFrontiersTasks},
                             {"BuildCountersTasks", R.BuildCountersTasks},
-                            {"NetworkReductions", R.NetworkReductions}};
+                            {"NetworkReductions", R.NetworkReductions},
+                            {"VectorizedSampling", CFG.vectorized_sampling},
+                            {"Lazy", CFG.lazy},
+                            {"CandidatesPerStep", R.CandidatesPerStep}};
 
   return experiment;
 }
@@ -108,6 +111,21 @@ int main(int argc, char** argv) {
   spdlog::set_level(spdlog::level::trace);
 
   ripples::parse_command_line(argc, argv);
+  if (ripples::configuration().scc_counting)
+    console->warn("--scc-counting is not supported by the MPI engine");
+  if (ripples::configuration().implicit_samples)
+    console->warn("--implicit-samples is not supported by the MPI engine");
+  if (ripples::configuration().compressed_samples)
+    console->warn("--compressed-samples is not supported by the MPI engine");
+  if (ripples::configuration().sketch_selection)
+    console->warn("--sketch-selection is not supported by the MPI engine");
+  if (ripples::configuration().counting_parallelism != "auto")
+    console->warn("--counting-parallelism is ignored by the MPI engine, "
+                  "which always splits the vertices of a sample");
+  if (ripples::configuration().vectorized_sampling &&
+      ripples::configuration().diffusionModel != "IC")
+    console->warn("--vectorized-sampling only supports IC: using the default "
+                  "sampler");
 
   trng::lcg64 weightGen;
   weightGen.seed(0UL);
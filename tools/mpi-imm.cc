@@ -83,6 +83,9 @@ auto GetExperimentRecord(const ToolConfiguration<IMMConfiguration> &CFG,
       {"NumThreads", R.NumThreads},
       {"NumWalkWorkers", CFG.streaming_workers},
       {"NumGPUWalkWorkers", CFG.streaming_gpu_workers},
+      {"DeterministicSampling", CFG.deterministic_sampling},
+      {"NUMADomains", CFG.numa_domains},
+      {"FusedCounting", CFG.fused_counting},
       {"Total", R.Total},
       {"ThetaPrimeDeltas", R.ThetaPrimeDeltas},
       {"ThetaEstimation", R.ThetaEstimationTotal},
@@ -91,6 +94,7 @@ auto GetExperimentRecord(const ToolConfiguration<IMMConfiguration> &CFG,
       {"Theta", R.Theta},
       {"GenerateRRRSets", R.GenerateRRRSets},
       {"FindMostInfluentialSet", R.FindMostInfluentialSet},
+      {"WalkWorkersIdle", R.WalkWorkersIdle},
       {"Seeds", seeds}};
   return experiment;
 }
@@ -127,7 +131,33 @@ int main(int argc, char *argv[]) {
       console->error("invalid command line");
       return -1;
     }
+    if (CFG.deterministic_sampling && CFG.streaming_gpu_workers != 0) {
+      console->error("deterministic sampling requires CPU-only walk workers");
+      return -1;
+    }
+    if (CFG.numa_domains > 1 && CFG.streaming_gpu_workers != 0) {
+      console->error("NUMA mode requires CPU-only walk workers");
+      return -1;
+    }
+    if (CFG.fused_counting && CFG.streaming_gpu_workers != 0) {
+      console->error("fused counting requires CPU-only walk workers");
+      return -1;
+    }
+  }
+  if (!CFG.save_rrr_sets.empty() || !CFG.load_rrr_sets.empty()) {
+    console->error("saving or loading RRR sets is not supported with MPI");
+    return -1;
+  }
+  if (!CFG.seed_set_sizes.empty()) {
+    console->error("--seed-set-sizes is not supported with MPI");
+    return -1;
   }
+  if (CFG.memory_budget != 0) {
+    console->error("--memory-budget is not supported with MPI");
+    return -1;
+  }
+  if (CFG.incremental_selection)
+    console->warn("--incremental-selection is ignored with MPI");
 
   trng::lcg64 weightGen;
   weightGen.seed(0UL);
@@ -151,9 +181,16 @@ int main(int argc, char *argv[]) {
   ripples::IMMExecutionRecord R;
 
   trng::lcg64 generator;
-  generator.seed(0UL);
+  generator.seed(CFG.rng_seed);
   generator.split(2, 1);
-  ripples::mpi::split_generator(generator);
+  // In deterministic mode the ranks interleave the indices of a single
+  // sequence of RRR sets instead of using independent sequences.
+  if (!CFG.deterministic_sampling) ripples::mpi::split_generator(generator);
+
+  // Find out rank, size
+  int world_rank, world_size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
 
   auto workers = CFG.streaming_workers;
   auto gpu_workers = CFG.streaming_gpu_workers;
@@ -164,6 +201,11 @@ int main(int argc, char *argv[]) {
         ripples::independent_cascade_tag>
         se(G, generator, R, workers - gpu_workers, gpu_workers,
            CFG.worker_to_gpu);
+    if (CFG.deterministic_sampling)
+      se.enable_deterministic_sampling(world_rank, world_size);
+    if (CFG.numa_domains > 1)
+      se.enable_numa(CFG.numa_domains, CFG.numa_graph_replicas);
+    if (CFG.fused_counting) se.enable_fused_counting();
     auto start = std::chrono::high_resolution_clock::now();
     seeds = ripples::mpi::IMM(
         G, CFG, 1.0, se, R, ripples::independent_cascade_tag{},
@@ -177,6 +219,11 @@ int main(int argc, char *argv[]) {
         ripples::linear_threshold_tag>
         se(G, generator, R, workers - gpu_workers, gpu_workers,
            CFG.worker_to_gpu);
+    if (CFG.deterministic_sampling)
+      se.enable_deterministic_sampling(world_rank, world_size);
+    if (CFG.numa_domains > 1)
+      se.enable_numa(CFG.numa_domains, CFG.numa_graph_replicas);
+    if (CFG.fused_counting) se.enable_fused_counting();
     auto start = std::chrono::high_resolution_clock::now();
     seeds = ripples::mpi::IMM(
         G, CFG, 1.0, se, R, ripples::linear_threshold_tag{},
@@ -194,13 +241,7 @@ int main(int argc, char *argv[]) {
   G.convertID(seeds.begin(), seeds.end(), seeds.begin());
   auto experiment = GetExperimentRecord(CFG, R, seeds);
   executionLog.push_back(experiment);
-  int world_size;
-  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
   console->info("IMM World Size : {}", world_size);
-
-  // Find out rank, size
-  int world_rank;
-  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
   console->info("IMM Rank : {}", world_rank);
 
   if (world_rank == 0) {
@@ -0,0 +1,212 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "ripples/configuration.h"
+#include "ripples/graph.h"
+#include "ripples/loaders.h"
+#include "ripples/opimc.h"
+#include "ripples/utility.h"
+
+#include "omp.h"
+
+#include "CLI/CLI.hpp"
+#include "nlohmann/json.hpp"
+
+#include "spdlog/fmt/ostr.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+#include "spdlog/spdlog.h"
+
+namespace ripples {
+
+template <typename SeedSet>
+auto GetExperimentRecord(const ToolConfiguration<OPIMCConfiguration> &CFG,
+                         const OPIMCExecutionRecord &R, const SeedSet &seeds) {
+  nlohmann::json experiment{
+      {"Algorithm", "OPIM-C"},
+      {"Input", CFG.IFileName},
+      {"Output", CFG.OutputFile},
+      {"DiffusionModel", CFG.diffusionModel},
+      {"Epsilon", CFG.epsilon},
+      {"Delta", CFG.delta},
+      {"K", CFG.k},
+      {"NumThreads", R.NumThreads},
+      {"NumWalkWorkers", CFG.streaming_workers},
+      {"NumGPUWalkWorkers", CFG.streaming_gpu_workers},
+      {"Total", R.Total},
+      {"Rounds", R.Rounds},
+      {"ThetaMax", R.ThetaMax},
+      {"Theta", R.Theta},
+      {"ThetaPrimeDeltas", R.ThetaPrimeDeltas},
+      {"LowerBounds", R.LowerBounds},
+      {"UpperBounds", R.UpperBounds},
+      {"Ratios", R.Ratios},
+      {"GenerateRRRSets", R.GenerateRRRSets},
+      {"FindMostInfluentialSet", R.FindMostInfluentialSet},
+      {"WalkWorkersIdle", R.WalkWorkersIdle},
+      {"Seeds", seeds}};
+  return experiment;
+}
+
+ToolConfiguration<ripples::OPIMCConfiguration> CFG;
+
+void parse_command_line(int argc, char **argv) {
+  CFG.ParseCmdOptions(argc, argv);
+#pragma omp single
+  CFG.streaming_workers = omp_get_max_threads();
+
+  if (CFG.seed_select_max_workers == 0)
+    CFG.seed_select_max_workers = CFG.streaming_workers;
+  if (CFG.seed_select_max_gpu_workers == std::numeric_limits<size_t>::max())
+    CFG.seed_select_max_gpu_workers = CFG.streaming_gpu_workers;
+}
+
+}  // namespace ripples
+
+int main(int argc, char **argv) {
+  auto console = spdlog::stdout_color_st("console");
+
+  // process command line
+  ripples::parse_command_line(argc, argv);
+  auto CFG = ripples::CFG;
+  if (ripples::streaming_command_line(
+          CFG.worker_to_gpu, CFG.streaming_workers, CFG.streaming_gpu_workers,
+          CFG.gpu_mapping_string) != 0) {
+    console->error("invalid command line");
+    return -1;
+  }
+  if ((CFG.deterministic_sampling || CFG.numa_domains > 1) &&
+      CFG.streaming_gpu_workers != 0) {
+    console->error("the requested mode requires CPU-only walk workers");
+    return -1;
+  }
+  if (CFG.fused_counting)
+    console->warn("--fused-counting is ignored by OPIM-C");
+  if (!CFG.seed_set_sizes.empty())
+    console->warn("--seed-set-sizes is ignored by OPIM-C");
+  if (CFG.memory_budget != 0) {
+    console->error("--memory-budget is not supported by OPIM-C");
+    return -1;
+  }
+  if (!CFG.save_rrr_sets.empty() || !CFG.load_rrr_sets.empty()) {
+    console->error("saving or loading RRR sets is not supported by OPIM-C");
+    return -1;
+  }
+
+  spdlog::set_level(spdlog::level::info);
+
+  trng::lcg64 weightGen;
+  weightGen.seed(0UL);
+  weightGen.split(2, 0);
+
+  using dest_type = ripples::WeightedDestination<uint32_t, float>;
+  using GraphFwd =
+      ripples::Graph<uint32_t, dest_type, ripples::ForwardDirection<uint32_t>>;
+  using GraphBwd =
+      ripples::Graph<uint32_t, dest_type, ripples::BackwardDirection<uint32_t>>;
+  console->info("Loading...");
+  GraphFwd Gf = ripples::loadGraph<GraphFwd>(CFG, weightGen);
+  GraphBwd G = Gf.get_transpose();
+  console->info("Loading Done!");
+  console->info("Number of Nodes : {}", G.num_nodes());
+  console->info("Number of Edges : {}", G.num_edges());
+
+  nlohmann::json executionLog;
+
+  std::vector<typename GraphBwd::vertex_type> seeds;
+  ripples::OPIMCExecutionRecord R;
+
+  trng::lcg64 generator;
+  generator.seed(CFG.rng_seed);
+  generator.split(2, 1);
+
+  auto workers = CFG.streaming_workers;
+  auto gpu_workers = CFG.streaming_gpu_workers;
+  auto start = std::chrono::high_resolution_clock::now();
+  if (CFG.diffusionModel == "IC") {
+    ripples::StreamingRRRGenerator<
+        decltype(G), decltype(generator),
+        typename ripples::RRRsets<decltype(G)>::iterator,
+        ripples::independent_cascade_tag>
+        se(G, generator, R, workers - gpu_workers, gpu_workers,
+           CFG.worker_to_gpu);
+    if (CFG.deterministic_sampling) se.enable_deterministic_sampling();
+    if (CFG.numa_domains > 1)
+      se.enable_numa(CFG.numa_domains, CFG.numa_graph_replicas);
+    seeds = ripples::OPIMC(G, CFG, se, R, ripples::independent_cascade_tag{},
+                           ripples::omp_parallel_tag{});
+  } else if (CFG.diffusionModel == "LT") {
+    ripples::StreamingRRRGenerator<
+        decltype(G), decltype(generator),
+        typename ripples::RRRsets<decltype(G)>::iterator,
+        ripples::linear_threshold_tag>
+        se(G, generator, R, workers - gpu_workers, gpu_workers,
+           CFG.worker_to_gpu);
+    if (CFG.deterministic_sampling) se.enable_deterministic_sampling();
+    if (CFG.numa_domains > 1)
+      se.enable_numa(CFG.numa_domains, CFG.numa_graph_replicas);
+    seeds = ripples::OPIMC(G, CFG, se, R, ripples::linear_threshold_tag{},
+                           ripples::omp_parallel_tag{});
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  R.Total = end - start;
+
+  console->info("OPIM-C : {}ms", R.Total.count());
+  console->info("RRR sets : {}", R.Theta);
+
+  size_t num_threads;
+#pragma omp single
+  num_threads = omp_get_max_threads();
+  R.NumThreads = num_threads;
+
+  G.convertID(seeds.begin(), seeds.end(), seeds.begin());
+  auto experiment = GetExperimentRecord(CFG, R, seeds);
+  executionLog.push_back(experiment);
+  std::ofstream perf(CFG.OutputFile);
+  perf << executionLog.dump(2);
+
+  return EXIT_SUCCESS;
+}
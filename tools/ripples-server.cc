@@ -0,0 +1,286 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+//             Ripples: A C++ Library for Influence Maximization
+//                  Marco Minutoli <marco.minutoli@pnnl.gov>
+//                   Pacific Northwest National Laboratory
+//
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2019, Battelle Memorial Institute
+//
+// Battelle Memorial Institute (hereinafter Battelle) hereby grants permission
+// to any person or entity lawfully obtaining a copy of this software and
+// associated documentation files (hereinafter “the Software”) to redistribute
+// and use the Software in source and binary forms, with or without
+// modification.  Such person or entity may use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and may permit
+// others to do so, subject to the following conditions:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Other than as used herein, neither the name Battelle Memorial Institute or
+//    Battelle may be used in any form whatsoever without the express written
+//    consent of Battelle.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL BATTELLE OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ripples/configuration.h"
+#include "ripples/graph.h"
+#include "ripples/loaders.h"
+#include "ripples/query_server.h"
+#include "ripples/utility.h"
+
+#include "omp.h"
+
+#include "CLI/CLI.hpp"
+#include "nlohmann/json.hpp"
+
+#include "spdlog/fmt/ostr.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+#include "spdlog/spdlog.h"
+
+namespace ripples {
+
+ToolConfiguration<ripples::QueryServerConfiguration> CFG;
+
+void parse_command_line(int argc, char **argv) {
+  CFG.ParseCmdOptions(argc, argv);
+#pragma omp single
+  CFG.streaming_workers = omp_get_max_threads();
+
+  if (CFG.seed_select_max_workers == 0)
+    CFG.seed_select_max_workers = CFG.streaming_workers;
+  if (CFG.seed_select_max_gpu_workers == std::numeric_limits<size_t>::max())
+    CFG.seed_select_max_gpu_workers = CFG.streaming_gpu_workers;
+}
+
+//! \brief Answer one line of the protocol.
+//!
+//! \param engine The query engine.
+//! \param line The request.
+//! \param shutdown Set when the request asks to stop the server.
+//! \return the response.
+template <typename EngineTy>
+std::string Answer(EngineTy &engine, const std::string &line, bool &shutdown) {
+  nlohmann::json request;
+  try {
+    request = nlohmann::json::parse(line);
+  } catch (const nlohmann::json::exception &e) {
+    return nlohmann::json{{"error", e.what()}}.dump();
+  }
+  if (request.is_object() && request.value("op", "") == "shutdown") {
+    shutdown = true;
+    return nlohmann::json{{"ok", true}}.dump();
+  }
+  return engine.handle(request).dump();
+}
+
+//! Serve requests, one JSON object per line, on stdin/stdout.
+template <typename EngineTy>
+int ServeStdin(EngineTy &engine) {
+  bool shutdown = false;
+  std::string line;
+  while (!shutdown && std::getline(std::cin, line)) {
+    if (line.empty()) continue;
+    std::cout << Answer(engine, line, shutdown) << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
+
+//! Serve requests, one JSON object per line, on a UNIX socket.  Clients are
+//! served one at a time.
+template <typename EngineTy>
+int ServeSocket(EngineTy &engine, const std::string &path) {
+  auto console = spdlog::get("console");
+  sockaddr_un address;
+  if (path.size() >= sizeof(address.sun_path)) {
+    console->error("socket path too long: {}", path);
+    return EXIT_FAILURE;
+  }
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(path.c_str());
+  if (server == -1 ||
+      bind(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) ||
+      listen(server, 8)) {
+    console->error("unable to listen on {}: {}", path, std::strerror(errno));
+    return EXIT_FAILURE;
+  }
+  console->info("Listening on {}", path);
+
+  bool shutdown = false;
+  while (!shutdown) {
+    int client = accept(server, nullptr, nullptr);
+    if (client == -1) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      // Out of descriptors or buffers: wait for resources to be released.
+      console->error("accept failed: {}", std::strerror(errno));
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      continue;
+    }
+
+    std::string buffer;
+    char data[4096];
+    ssize_t received;
+    bool connected = true;
+    while (connected && !shutdown &&
+           (received = read(client, data, sizeof(data))) > 0) {
+      buffer.append(data, received);
+      size_t newline;
+      while (connected && !shutdown &&
+             (newline = buffer.find('\n')) != std::string::npos) {
+        std::string line = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        if (line.empty()) continue;
+
+        // MSG_NOSIGNAL: a client leaving mid-reply gets dropped (EPIPE)
+        // instead of killing the server with SIGPIPE.
+        std::string response = Answer(engine, line, shutdown) + "\n";
+        for (size_t sent = 0; sent < response.size();) {
+          ssize_t n = send(client, response.data() + sent,
+                           response.size() - sent, MSG_NOSIGNAL);
+          if (n == -1 && errno == EINTR) continue;
+          if (n <= 0) {
+            console->warn("dropping client: {}", std::strerror(errno));
+            connected = false;
+            break;
+          }
+          sent += n;
+        }
+      }
+    }
+    close(client);
+  }
+  close(server);
+  unlink(path.c_str());
+  return EXIT_SUCCESS;
+}
+
+template <typename EngineTy>
+int Serve(EngineTy &engine, const std::string &socket_path) {
+  if (socket_path.empty()) return ServeStdin(engine);
+  return ServeSocket(engine, socket_path);
+}
+
+}  // namespace ripples
+
+int main(int argc, char **argv) {
+  // stdout carries the protocol: logs go to stderr.
+  auto console = spdlog::stderr_color_st("console");
+  spdlog::stderr_color_st("Streaming Generator");
+
+  // process command line
+  ripples::parse_command_line(argc, argv);
+  auto CFG = ripples::CFG;
+  if (ripples::streaming_command_line(
+          CFG.worker_to_gpu, CFG.streaming_workers, CFG.streaming_gpu_workers,
+          CFG.gpu_mapping_string) != 0) {
+    console->error("invalid command line");
+    return -1;
+  }
+  if (CFG.streaming_gpu_workers != 0) {
+    console->error("the server requires CPU-only walk workers");
+    return -1;
+  }
+  if (CFG.memory_budget != 0) {
+    console->error("--memory-budget is not supported by the server");
+    return -1;
+  }
+  if (!CFG.save_rrr_sets.empty() || !CFG.load_rrr_sets.empty()) {
+    console->error("saving or loading RRR sets is not supported by the "
+                   "server");
+    return -1;
+  }
+  if (CFG.incremental_selection)
+    console->warn("--incremental-selection is ignored by the server");
+  if (!CFG.seed_set_sizes.empty())
+    console->warn("--seed-set-sizes is ignored by the server");
+
+  spdlog::set_level(spdlog::level::info);
+
+  trng::lcg64 weightGen;
+  weightGen.seed(0UL);
+  weightGen.split(2, 0);
+
+  using dest_type = ripples::WeightedDestination<uint32_t, float>;
+  using GraphFwd =
+      ripples::Graph<uint32_t, dest_type, ripples::ForwardDirection<uint32_t>>;
+  using GraphBwd =
+      ripples::Graph<uint32_t, dest_type, ripples::BackwardDirection<uint32_t>>;
+  console->info("Loading...");
+  GraphFwd Gf = ripples::loadGraph<GraphFwd>(CFG, weightGen);
+  GraphBwd G = Gf.get_transpose();
+  console->info("Loading Done!");
+  console->info("Number of Nodes : {}", G.num_nodes());
+  console->info("Number of Edges : {}", G.num_edges());
+
+  trng::lcg64 generator;
+  generator.seed(CFG.rng_seed);
+  generator.split(2, 1);
+
+  ripples::IMMExecutionRecord R;
+  auto workers = CFG.streaming_workers;
+  if (CFG.diffusionModel == "IC") {
+    using generator_type = ripples::StreamingRRRGenerator<
+        decltype(G), decltype(generator),
+        typename ripples::RRRsets<decltype(G)>::iterator,
+        ripples::independent_cascade_tag>;
+    generator_type se(G, generator, R, workers, 0, CFG.worker_to_gpu);
+    se.enable_deterministic_sampling();
+    if (CFG.numa_domains > 1)
+      se.enable_numa(CFG.numa_domains, CFG.numa_graph_replicas);
+    if (CFG.fused_counting) se.enable_fused_counting();
+    ripples::QueryEngine<decltype(G), decltype(CFG), generator_type,
+                         ripples::independent_cascade_tag>
+        engine(G, CFG, se, R);
+    return ripples::Serve(engine, CFG.socket_path);
+  } else if (CFG.diffusionModel == "LT") {
+    using generator_type = ripples::StreamingRRRGenerator<
+        decltype(G), decltype(generator),
+        typename ripples::RRRsets<decltype(G)>::iterator,
+        ripples::linear_threshold_tag>;
+    generator_type se(G, generator, R, workers, 0, CFG.worker_to_gpu);
+    se.enable_deterministic_sampling();
+    if (CFG.numa_domains > 1)
+      se.enable_numa(CFG.numa_domains, CFG.numa_graph_replicas);
+    if (CFG.fused_counting) se.enable_fused_counting();
+    ripples::QueryEngine<decltype(G), decltype(CFG), generator_type,
+                         ripples::linear_threshold_tag>
+        engine(G, CFG, se, R);
+    return ripples::Serve(engine, CFG.socket_path);
+  }
+
+  console->error("unknown diffusion model {}", CFG.diffusionModel);
+  return -1;
+}
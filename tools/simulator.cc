@@ -40,7 +40,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "CLI/CLI.hpp"
 #include "nlohmann/json.hpp"
@@ -51,10 +56,16 @@
 #include "trng/lcg64.hpp"
 #include "trng/uniform_int_dist.hpp"
 
+#include "ripples/bit_parallel_simulation.h"
 #include "ripples/configuration.h"
+#include "ripples/crn_evaluation.h"
 #include "ripples/diffusion_simulation.h"
 #include "ripples/graph.h"
+#include "ripples/imm_execution_record.h"
 #include "ripples/loaders.h"
+#include "ripples/rrr_sample_store.h"
+#include "ripples/spread_estimation.h"
+#include "ripples/streaming_rrr_generator.h"
 
 #include "omp.h"
 
@@ -63,7 +74,16 @@ namespace ripples {
 struct SimulatorConfiguration {
   std::string EFileName;
   std::string diffusionModel;
-  std::size_t Replicas;
+  std::size_t Replicas{0};
+  std::size_t RRRSets{0};
+  std::string LoadRRRSets;
+  uint64_t RRRSeed{1};
+  double Confidence{0.95};
+  std::size_t Worlds{0};
+  double TargetError{0};
+  std::size_t BatchReplicas{256};
+  std::size_t CRNWorlds{0};
+  uint64_t CRNSeed{0};
 
   void addCmdOptions(CLI::App &app) {
     app.add_option("-e,--experiment-file", EFileName,
@@ -72,26 +92,239 @@ struct SimulatorConfiguration {
         ->group("Simulator Options")
         ->required();
     app.add_option("--replicas", Replicas,
-                   "The number of experimental replicas.")
-        ->group("Simulator Options")
-        ->required();
+                   "The number of experimental replicas (the maximum with "
+                   "--target-relative-error).")
+        ->group("Simulator Options");
+    app.add_option("--rrr-sets", RRRSets,
+                   "Estimate the spread over this many fresh RRR sets instead "
+                   "of simulating.")
+        ->group("Simulator Options");
+    app.add_option("--load-rrr-sets", LoadRRRSets,
+                   "Estimate the spread over RRR sets saved by imm (with the "
+                   "seed stored in the file).")
+        ->group("Simulator Options");
+    // IMM samples with seed 0 by default: fresh RRR sets are independent of
+    // the ones used to select the seeds.
+    app.add_option("--rrr-seed", RRRSeed, "The seed of the fresh RRR sets.")
+        ->group("Simulator Options");
+    app.add_option("--confidence", Confidence,
+                   "The confidence level of the spread estimates.")
+        ->group("Simulator Options");
+    app.add_option("--bit-parallel-worlds", Worlds,
+                   "Simulate IC replicas in batches of 64 or 256 worlds.")
+        ->group("Simulator Options");
+    app.add_option("--target-relative-error", TargetError,
+                   "Stop adding replicas when the half-width of the spread "
+                   "interval falls below this fraction of the mean "
+                   "(--replicas is then the cap).")
+        ->group("Simulator Options");
+    app.add_option("--batch-replicas", BatchReplicas,
+                   "The number of replicas run between two checks of the "
+                   "interval.")
+        ->group("Simulator Options");
+    app.add_option("--crn-worlds", CRNWorlds,
+                   "Evaluate all the seed sets on this many common worlds.")
+        ->group("Simulator Options");
+    app.add_option("--crn-seed", CRNSeed,
+                   "The seed of the common worlds.")
+        ->group("Simulator Options");
   }
 };
 
-template <typename Sims>
 auto GetExperimentRecord(const SimulatorConfiguration &CFG,
-                         const nlohmann::json &experimentRecord,
-                         const Sims &experiments) {
+                         const nlohmann::json &experimentRecord) {
   nlohmann::json experiment{{"Input", experimentRecord["Input"]},
                             {"Algorithm", experimentRecord["Algorithm"]},
                             {"DiffusionModel", CFG.diffusionModel},
                             {"Epsilon", experimentRecord["Epsilon"]},
                             {"K", experimentRecord["K"]},
-                            {"Seeds", experimentRecord["Seeds"]},
-                            {"Simulations", experiments}};
+                            {"Seeds", experimentRecord["Seeds"]}};
   return experiment;
 }
 
+nlohmann::json GetSpreadRecord(const SimulatorConfiguration &CFG,
+                               const SpreadEstimate &E) {
+  return nlohmann::json{{"Spread", E.Spread},
+                        {"Coverage", E.Coverage},
+                        {"Lower", E.Lower},
+                        {"Upper", E.Upper},
+                        {"Samples", E.Samples},
+                        {"Confidence", CFG.Confidence}};
+}
+
+//! Run IC replicas in batches of Worlds, one simulator per thread.
+template <size_t Worlds, typename GraphTy, typename VertexTy, typename Itr>
+void BitParallelSimulations(const GraphTy &G,
+                            const std::vector<VertexTy> &seeds,
+                            std::vector<trng::lcg64> &generator, Itr begin,
+                            Itr end) {
+  size_t num_replicas = std::distance(begin, end);
+  size_t num_batches = (num_replicas + Worlds - 1) / Worlds;
+#pragma omp parallel
+  {
+    BitParallelICSimulator<GraphTy, Worlds> simulator(G);
+#pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < num_batches; ++b) {
+      auto worlds = simulator.simulate(seeds.begin(), seeds.end(),
+                                       generator[omp_get_thread_num()]);
+      size_t first = b * Worlds;
+      size_t last = std::min(first + Worlds, num_replicas);
+      std::copy(worlds.begin(), worlds.begin() + (last - first),
+                begin + first);
+    }
+  }
+}
+
+//! Run the replicas in [begin, end) with the engine selected by CFG.
+template <typename GraphTy, typename VertexTy, typename Itr>
+void RunReplicas(const SimulatorConfiguration &CFG, const GraphTy &G,
+                 const std::vector<VertexTy> &seeds,
+                 std::vector<trng::lcg64> &generator, Itr begin, Itr end) {
+  size_t num_replicas = std::distance(begin, end);
+  if (CFG.Worlds == 64) {
+    BitParallelSimulations<64>(G, seeds, generator, begin, end);
+  } else if (CFG.Worlds == 256) {
+    BitParallelSimulations<256>(G, seeds, generator, begin, end);
+  } else if (CFG.diffusionModel == "LT") {
+#pragma omp parallel
+    {
+      LTSimulator<GraphTy> simulator(G);
+#pragma omp for schedule(dynamic)
+      for (size_t i = 0; i < num_replicas; ++i)
+        begin[i] = simulator.simulate(seeds.begin(), seeds.end(),
+                                      generator[omp_get_thread_num()]);
+    }
+  } else if (CFG.diffusionModel == "IC") {
+#pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < num_replicas; ++i)
+      begin[i] = simulate(G, seeds.begin(), seeds.end(),
+                          generator[omp_get_thread_num()],
+                          independent_cascade_tag{});
+  } else {
+    throw std::string("Not Yet Implemented");
+  }
+}
+
+//! The confidence interval of the mean spread over a set of replicas.
+struct ReplicaInterval {
+  double Mean;
+  double Lower;
+  double Upper;
+  double RelativeHalfWidth;
+};
+
+inline ReplicaInterval GetReplicaInterval(double n, double sum,
+                                          double sum_squares,
+                                          double confidence) {
+  double mean = sum / n;
+  double variance =
+      n > 1 ? std::max(0.0, (sum_squares - n * mean * mean) / (n - 1)) : 0;
+  double half = NormalQuantile((1 + confidence) / 2) * std::sqrt(variance / n);
+  return ReplicaInterval{mean, mean - half, mean + half,
+                         mean > 0 ? half / mean : 0};
+}
+
+template <typename Itr>
+ReplicaInterval GetReplicaInterval(Itr begin, Itr end, double confidence) {
+  double sum = 0, sum_squares = 0;
+  for (auto itr = begin; itr != end; ++itr) {
+    sum += itr->first;
+    sum_squares += double(itr->first) * itr->first;
+  }
+  return GetReplicaInterval(std::distance(begin, end), sum, sum_squares,
+                            confidence);
+}
+
+nlohmann::json GetIntervalRecord(const SimulatorConfiguration &CFG,
+                                 const ReplicaInterval &I, size_t replicas) {
+  return nlohmann::json{{"Mean", I.Mean},
+                        {"Lower", I.Lower},
+                        {"Upper", I.Upper},
+                        {"RelativeHalfWidth", I.RelativeHalfWidth},
+                        {"Confidence", CFG.Confidence},
+                        {"Replicas", replicas}};
+}
+
+//! The moments of the spreads of many seed sets over common worlds.
+//!
+//! Differences are taken against the first seed set: being paired on the
+//! same worlds, their variance is much lower than with independent runs.
+struct CRNMoments {
+  std::vector<double> Sum;
+  std::vector<double> SumSquares;
+  std::vector<double> DifferenceSum;
+  std::vector<double> DifferenceSumSquares;
+
+  explicit CRNMoments(size_t num_sets)
+      : Sum(num_sets, 0),
+        SumSquares(num_sets, 0),
+        DifferenceSum(num_sets, 0),
+        DifferenceSumSquares(num_sets, 0) {}
+
+  void add(const std::vector<size_t> &activated) {
+    for (size_t s = 0; s < activated.size(); ++s) {
+      double x = activated[s];
+      double d = x - double(activated[0]);
+      Sum[s] += x;
+      SumSquares[s] += x * x;
+      DifferenceSum[s] += d;
+      DifferenceSumSquares[s] += d * d;
+    }
+  }
+
+  void merge(const CRNMoments &O) {
+    for (size_t s = 0; s < Sum.size(); ++s) {
+      Sum[s] += O.Sum[s];
+      SumSquares[s] += O.SumSquares[s];
+      DifferenceSum[s] += O.DifferenceSum[s];
+      DifferenceSumSquares[s] += O.DifferenceSumSquares[s];
+    }
+  }
+};
+
+//! Evaluate all the seed sets on CFG.CRNWorlds common worlds.
+template <typename GraphTy, typename SeedSetsTy, typename diff_model_tag>
+CRNMoments CRNEvaluation(const SimulatorConfiguration &CFG, const GraphTy &G,
+                         const SeedSetsTy &seed_sets,
+                         diff_model_tag &&model_tag) {
+  CRNMoments moments(seed_sets.size());
+#pragma omp parallel
+  {
+    CRNEvaluator<GraphTy> evaluator(G, CFG.CRNSeed, model_tag);
+    CRNMoments local(seed_sets.size());
+#pragma omp for schedule(dynamic, 16)
+    for (size_t world = 0; world < CFG.CRNWorlds; ++world)
+      local.add(evaluator.evaluate(seed_sets, world));
+#pragma omp critical
+    moments.merge(local);
+  }
+  return moments;
+}
+
+//! Generate fresh RRR sets with the streaming engine.
+template <typename GraphTy, typename diff_model_tag>
+RRRsets<GraphTy> SampleRRRSets(const GraphTy &G, size_t num_sets,
+                               uint64_t seed, diff_model_tag &&) {
+  trng::lcg64 generator;
+  generator.seed(seed);
+  generator.split(2, 1);
+
+  size_t num_threads(1);
+#pragma omp single
+  num_threads = omp_get_max_threads();
+
+  IMMExecutionRecord R;
+  std::unordered_map<size_t, size_t> worker_to_gpu;
+  StreamingRRRGenerator<GraphTy, trng::lcg64,
+                        typename RRRsets<GraphTy>::iterator, diff_model_tag>
+      se(G, generator, R, num_threads, 0, worker_to_gpu);
+  se.enable_deterministic_sampling();
+
+  RRRsets<GraphTy> RR(num_sets);
+  se.generate(RR.begin(), RR.end());
+  return RR;
+}
+
 }  // namespace ripples
 
 using Configuration =
@@ -127,6 +360,140 @@ int main(int argc, char **argv) {
   console->info("Number of Edges : {}", G.num_edges());
 
   nlohmann::json simRecordLog;
+  if (CFG.RRRSets != 0 || !CFG.LoadRRRSets.empty()) {
+    using GraphBwd = ripples::Graph<uint32_t, edge_type,
+                                    ripples::BackwardDirection<uint32_t>>;
+    GraphBwd Gbwd = G.get_transpose();
+
+    ripples::RRRsets<GraphBwd> RR;
+    if (!CFG.LoadRRRSets.empty()) {
+      // Saved sets are usually the ones the seeds were selected from: the
+      // estimate is then in-sample and biased upward.
+      console->warn(
+          "Estimating the spread over loaded RRR sets: if the seeds were "
+          "selected from them, the estimate is biased upward (use --rrr-sets "
+          "for an independent estimate).");
+      RR = ripples::LoadRRRSets(CFG.LoadRRRSets, Gbwd, CFG.diffusionModel,
+                                ripples::LoadRRRSetsSeed(CFG.LoadRRRSets));
+    } else if (CFG.diffusionModel == "IC") {
+      RR = ripples::SampleRRRSets(Gbwd, CFG.RRRSets, CFG.RRRSeed,
+                                  ripples::independent_cascade_tag{});
+    } else if (CFG.diffusionModel == "LT") {
+      RR = ripples::SampleRRRSets(Gbwd, CFG.RRRSets, CFG.RRRSeed,
+                                  ripples::linear_threshold_tag{});
+    } else {
+      throw std::string("Not Yet Implemented");
+    }
+    console->info("RRR sets : {}", RR.size());
+
+    size_t num_threads(1);
+#pragma omp single
+    num_threads = omp_get_max_threads();
+    ripples::RRRCoverageIndex<GraphBwd> index(Gbwd, RR, num_threads);
+    ripples::RRRsets<GraphBwd>().swap(RR);
+
+    using vertex_type = typename Graph::vertex_type;
+    for (auto &record : experimentRecord) {
+      auto experiment = ripples::GetExperimentRecord(CFG, record);
+
+      std::vector<vertex_type> seeds = record["Seeds"];
+      G.transformID(seeds.begin(), seeds.end(), seeds.begin());
+      experiment["SpreadEstimate"] = ripples::GetSpreadRecord(
+          CFG, index.estimate(seeds.begin(), seeds.end(), CFG.Confidence));
+
+      // Seed sets of several sizes reported by imm --seed-set-sizes.
+      if (record.count("SeedSets")) {
+        for (auto &seedSet : record["SeedSets"]) {
+          std::vector<vertex_type> prefix = seedSet["Seeds"];
+          G.transformID(prefix.begin(), prefix.end(), prefix.begin());
+          experiment["SeedSets"].push_back(
+              {{"K", seedSet["K"]},
+               {"SpreadEstimate",
+                ripples::GetSpreadRecord(
+                    CFG, index.estimate(prefix.begin(), prefix.end(),
+                                        CFG.Confidence))}});
+        }
+      }
+      simRecordLog.push_back(experiment);
+    }
+    simRecord->info("{}", simRecordLog.dump(2));
+    return EXIT_SUCCESS;
+  }
+
+  if (CFG.CRNWorlds != 0) {
+    // Every record and every prefix from --seed-set-sizes is a seed set.
+    using vertex_type = typename Graph::vertex_type;
+    std::vector<std::vector<vertex_type>> seedSets;
+    for (auto &record : experimentRecord) {
+      seedSets.push_back(record["Seeds"]);
+      if (record.count("SeedSets"))
+        for (auto &seedSet : record["SeedSets"])
+          seedSets.push_back(seedSet["Seeds"]);
+    }
+    for (auto &seeds : seedSets)
+      G.transformID(seeds.begin(), seeds.end(), seeds.begin());
+
+    ripples::CRNMoments moments(seedSets.size());
+    if (CFG.diffusionModel == "IC") {
+      moments = ripples::CRNEvaluation(CFG, G, seedSets,
+                                       ripples::independent_cascade_tag{});
+    } else if (CFG.diffusionModel == "LT") {
+      moments = ripples::CRNEvaluation(CFG, G, seedSets,
+                                       ripples::linear_threshold_tag{});
+    } else {
+      throw std::string("Not Yet Implemented");
+    }
+
+    auto getCRNRecord = [&](size_t s) {
+      double n = CFG.CRNWorlds;
+      return nlohmann::json{
+          {"Spread",
+           ripples::GetIntervalRecord(
+               CFG,
+               ripples::GetReplicaInterval(n, moments.Sum[s],
+                                           moments.SumSquares[s],
+                                           CFG.Confidence),
+               CFG.CRNWorlds)},
+          {"DifferenceFromFirst",
+           ripples::GetIntervalRecord(
+               CFG,
+               ripples::GetReplicaInterval(n, moments.DifferenceSum[s],
+                                           moments.DifferenceSumSquares[s],
+                                           CFG.Confidence),
+               CFG.CRNWorlds)}};
+    };
+
+    size_t s = 0;
+    for (auto &record : experimentRecord) {
+      auto experiment = ripples::GetExperimentRecord(CFG, record);
+      experiment["CommonWorlds"] = getCRNRecord(s++);
+      if (record.count("SeedSets")) {
+        for (auto &seedSet : record["SeedSets"])
+          experiment["SeedSets"].push_back(
+              {{"K", seedSet["K"]}, {"CommonWorlds", getCRNRecord(s++)}});
+      }
+      simRecordLog.push_back(experiment);
+    }
+    simRecord->info("{}", simRecordLog.dump(2));
+    return EXIT_SUCCESS;
+  }
+
+  if (CFG.Replicas == 0) {
+    console->error(
+        "one of --replicas, --rrr-sets, --load-rrr-sets, --crn-worlds is "
+        "needed");
+    return EXIT_FAILURE;
+  }
+  if (CFG.TargetError != 0 && CFG.BatchReplicas == 0) {
+    console->error("--batch-replicas must be positive");
+    return EXIT_FAILURE;
+  }
+  if (CFG.Worlds != 0 &&
+      (CFG.diffusionModel != "IC" || (CFG.Worlds != 64 && CFG.Worlds != 256))) {
+    console->error("--bit-parallel-worlds supports IC with 64 or 256 worlds");
+    return EXIT_FAILURE;
+  }
+
   for (auto &record : experimentRecord) {
     using vertex_type = typename Graph::vertex_type;
 
@@ -148,22 +515,30 @@ int main(int argc, char **argv) {
                                             omp_get_thread_num());
     }
 
-#pragma omp parallel for schedule(dynamic)
-    for (size_t i = 0; i < experiments.size(); ++i) {
-      if (CFG.diffusionModel == "IC") {
-        experiments[i] = simulate(G, seeds.begin(), seeds.end(),
-                                  generator[omp_get_thread_num()],
-                                  ripples::independent_cascade_tag{});
-      } else if (CFG.diffusionModel == "LT") {
-        experiments[i] = simulate(G, seeds.begin(), seeds.end(),
-                                  generator[omp_get_thread_num()],
-                                  ripples::linear_threshold_tag{});
-      } else {
-        throw std::string("Not Yet Implemented");
+    if (CFG.TargetError == 0) {
+      ripples::RunReplicas(CFG, G, seeds, generator, experiments.begin(),
+                           experiments.end());
+    } else {
+      // Run batches until the interval is tight enough or the cap is hit.
+      experiments.clear();
+      while (experiments.size() < CFG.Replicas) {
+        size_t first = experiments.size();
+        experiments.resize(
+            std::min(first + CFG.BatchReplicas, size_t(CFG.Replicas)));
+        ripples::RunReplicas(CFG, G, seeds, generator,
+                             experiments.begin() + first, experiments.end());
+        auto interval = ripples::GetReplicaInterval(
+            experiments.begin(), experiments.end(), CFG.Confidence);
+        if (interval.RelativeHalfWidth <= CFG.TargetError) break;
       }
     }
-    simRecordLog.push_back(
-        ripples::GetExperimentRecord(CFG, record, experiments));
+    auto interval = ripples::GetReplicaInterval(
+        experiments.begin(), experiments.end(), CFG.Confidence);
+    auto experiment = ripples::GetExperimentRecord(CFG, record);
+    experiment["Simulations"] = experiments;
+    experiment["SpreadInterval"] =
+        ripples::GetIntervalRecord(CFG, interval, experiments.size());
+    simRecordLog.push_back(experiment);
   }
   simRecord->info("{}", simRecordLog.dump(2));
 